@@ -0,0 +1,234 @@
+#ifndef	_INCLUDED_ASYNCFUNCTION_H
+#define	_INCLUDED_ASYNCFUNCTION_H
+
+
+#ifndef	_SDL_H
+	#include <SDL.h>
+#endif
+
+#ifndef	_INCLUDED_SDLAATOMIC_H
+	#include <SDLAAtomic.h>
+#endif
+
+#ifndef	_INCLUDED_FUNCTION_H
+	#include "Function.h"
+#endif
+
+
+// A function whose arc-length table can be rebuilt on a worker thread while queries carry
+// on against the previous one. Each build creates a new function from scratch which is
+// published with a single atomic pointer swap, so readers only ever see complete tables.
+//
+// Readers announce themselves in one of two counters picked by the current epoch. After
+// publishing, the worker flips the epoch and waits for the counter of the old one to drain
+// before deleting the previous function; nobody can still be using it at that point.
+// Readers never wait and the worker only waits for readers that started before the swap.
+template <int N, typename T> class tAsyncFunction
+{
+	// A published function, defined below
+	struct Snapshot;
+
+public:
+	// The first table is built straight away with the given coefficients
+	tAsyncFunction(const T* curve, const float tolerance, const float max_dist) :
+
+		m_Epoch(0),
+		m_IsBuilding(0),
+		m_Thread(0),
+		m_NextVersion(0),
+		m_Tolerance(tolerance),
+		m_MaxDist(max_dist)
+
+	{
+		m_Readers[0] = 0;
+		m_Readers[1] = 0;
+
+		m_Current = Build(curve, tolerance, max_dist, 0);
+	}
+
+
+	~tAsyncFunction(void)
+	{
+		Wait();
+
+		Snapshot* current = (Snapshot*)m_Current;
+		delete current->function;
+		delete current;
+	}
+
+
+	// Start building a new function with the given coefficients, one per dimension. This
+	// returns false without doing anything if the last build hasn't finished yet.
+	bool Rebuild(const T* curve, const float tolerance, const float max_dist)
+	{
+		if (IsRebuilding())
+			return (false);
+
+		// Clean up after the last build
+		Wait();
+
+		// Only this thread publishes so the current version can't change under it
+		Snapshot* current = (Snapshot*)SDLAAtomicLoadPointer(&m_Current);
+		m_NextVersion = current->version + 1;
+		for (int i = 0; i < N; i++)
+			m_NextCurve[i] = curve[i];
+		m_Tolerance = tolerance;
+		m_MaxDist = max_dist;
+
+		SDLAAtomicExchange(&m_IsBuilding, 1);
+		if ((m_Thread = SDL_CreateThread(BuildThread, this)) == 0)
+		{
+			SDLAAtomicExchange(&m_IsBuilding, 0);
+			return (false);
+		}
+
+		return (true);
+	}
+
+
+	// Has a build been started that isn't published yet?
+	bool IsRebuilding(void) const
+	{
+		return (SDLAAtomicLoad(const_cast<volatile long*>(&m_IsBuilding)) != 0);
+	}
+
+
+	// Block until any build in progress has been published
+	void Wait(void)
+	{
+		if (m_Thread)
+		{
+			SDL_WaitThread(m_Thread, 0);
+			m_Thread = 0;
+		}
+	}
+
+
+	// Keeps hold of the current function for as long as it's in scope, so it can't be
+	// deleted by a rebuild. Use it like a pointer to the function:
+	//
+	//		tAsyncFunction<2, CubicPolynomial>::Reader f_ptr(async);
+	//		float u = f_ptr->GetParameterNewtonRaphson(s);
+	//
+	class Reader
+	{
+	public:
+		Reader(tAsyncFunction<N, T>& async) : m_Async(async)
+		{
+			// Register in the current epoch, retrying if it changes before that's visible
+			while (1)
+			{
+				m_Epoch = SDLAAtomicLoad(&async.m_Epoch);
+				SDLAAtomicIncrement(&async.m_Readers[m_Epoch]);
+				if (SDLAAtomicLoad(&async.m_Epoch) == m_Epoch)
+					break;
+				SDLAAtomicDecrement(&async.m_Readers[m_Epoch]);
+			}
+
+			m_Snapshot = (const Snapshot*)SDLAAtomicLoadPointer(&async.m_Current);
+		}
+
+
+		~Reader(void)
+		{
+			SDLAAtomicDecrement(&m_Async.m_Readers[m_Epoch]);
+		}
+
+
+		const tFunction<N, T>* operator -> (void) const
+		{
+			return (m_Snapshot->function);
+		}
+
+
+		const tFunction<N, T>& operator * (void) const
+		{
+			return (*m_Snapshot->function);
+		}
+
+
+		// Increases by one with each published build, starting at zero
+		int GetVersion(void) const
+		{
+			return (m_Snapshot->version);
+		}
+
+
+	private:
+		tAsyncFunction<N, T>&	m_Async;
+
+		long			m_Epoch;
+		const Snapshot*	m_Snapshot;
+	};
+
+	friend class Reader;
+
+
+private:
+	struct Snapshot
+	{
+		tFunction<N, T>*	function;
+
+		int		version;
+	};
+
+
+	static Snapshot* Build(const T* curve, const float tolerance, const float max_dist, const int version)
+	{
+		Snapshot* snapshot = new Snapshot;
+		snapshot->version = version;
+
+		// The table from the constructor is replaced by the adaptive one
+		snapshot->function = new tFunction<N, T>(1);
+		for (int i = 0; i < N; i++)
+			snapshot->function->curve[i] = curve[i];
+		snapshot->function->InitTableAdaptiveGaussian(tolerance, max_dist);
+
+		return (snapshot);
+	}
+
+
+	static int BuildThread(void* data)
+	{
+		tAsyncFunction<N, T>* async = (tAsyncFunction<N, T>*)data;
+
+		Snapshot* next = Build(async->m_NextCurve, async->m_Tolerance, async->m_MaxDist, async->m_NextVersion);
+
+		// Publish, from here on new readers get the new function
+		Snapshot* old = (Snapshot*)SDLAAtomicExchangePointer(&async->m_Current, next);
+
+		// Move new readers over to the other counter and wait for the ones that might
+		// have the old function to finish with it
+		long epoch = SDLAAtomicLoad(&async->m_Epoch);
+		SDLAAtomicExchange(&async->m_Epoch, epoch ^ 1);
+		while (SDLAAtomicLoad(&async->m_Readers[epoch]))
+			SDL_Delay(0);
+
+		delete old->function;
+		delete old;
+
+		SDLAAtomicExchange(&async->m_IsBuilding, 0);
+		return (0);
+	}
+
+
+	// Snapshot being served to readers
+	void* volatile	m_Current;
+
+	// Which reader counter new readers use, and the counters themselves
+	volatile long	m_Epoch;
+	volatile long	m_Readers[2];
+
+	// Set from the start of a rebuild until the old function has been released
+	volatile long	m_IsBuilding;
+
+	// Worker doing the rebuild and what it's building
+	SDL_Thread*	m_Thread;
+	T			m_NextCurve[N];
+	int			m_NextVersion;
+	float		m_Tolerance;
+	float		m_MaxDist;
+};
+
+
+#endif	/* _INCLUDED_ASYNCFUNCTION_H */
@@ -0,0 +1,300 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <SDLATimer.h>
+#include "../CubicPolynomial.h"
+#include "../BulkBaker.h"
+#include "../CurvePack.h"
+#include "../LazyTable.h"
+
+
+typedef tFunction<2, CubicPolynomial> Function;
+
+
+// Same table settings as the demo
+static const float TABLE_TOLERANCE = 1e-6f;
+static const float TABLE_MAX_DIST = 0.5f;
+
+// One curve in this many is a giant one, this much bigger than the rest
+static const int GIANT_EVERY = 500;
+static const float GIANT_SCALE = 100.0f;
+
+// Each thread count is timed this many times, keeping the fastest
+static const int NB_REPEATS = 3;
+
+// Number of times each curve is queried when timing parameter lookups
+static const int NB_QUERY_REPEATS = 20;
+
+
+inline float Random(void)
+{
+	return ((float)rand() / (float)RAND_MAX);
+}
+
+
+Function** CreateFunctions(const int nb_functions)
+{
+	Function** functions = new Function*[nb_functions];
+
+	for (int i = 0; i < nb_functions; i++)
+	{
+		float scale = (i % GIANT_EVERY) == GIANT_EVERY - 1 ? GIANT_SCALE : 1.0f;
+
+		// Start with the smallest table, it's replaced by the adaptive one
+		functions[i] = new Function(1);
+		for (int j = 0; j < 2; j++)
+		{
+			functions[i]->curve[j].a = (Random() - 0.5f) * scale;
+			functions[i]->curve[j].b = (Random() - 0.5f) * scale;
+			functions[i]->curve[j].c = (Random() - 0.5f) * scale;
+			functions[i]->curve[j].d = (Random() - 0.5f) * scale;
+		}
+	}
+
+	return (functions);
+}
+
+
+void ReleaseFunctions(Function** functions, const int nb_functions)
+{
+	for (int i = 0; i < nb_functions; i++)
+		delete functions[i];
+	delete [] functions;
+}
+
+
+// Largest difference in total length from the reference, relative to the length
+float CompareLengths(Function** functions, Function** reference, const int nb_functions)
+{
+	float max_error = 0;
+
+	for (int i = 0; i < nb_functions; i++)
+	{
+		float length = functions[i]->arc_lengths[functions[i]->nb_entries * 2 - 1];
+		float expected = reference[i]->arc_lengths[reference[i]->nb_entries * 2 - 1];
+
+		float error = (float)fabs(length - expected) / expected;
+		if (error > max_error)
+			max_error = error;
+	}
+
+	return (max_error);
+}
+
+
+// Times one arc-length to parameter query on each curve, first with a call per curve and
+// then with all of them packed together
+void TimeQueries(Function** functions, const int nb_functions)
+{
+	float* s = new float[nb_functions];
+	float* u_single = new float[nb_functions];
+	float* u_packed = new float[nb_functions];
+
+	for (int i = 0; i < nb_functions; i++)
+		s[i] = Random() * functions[i]->arc_lengths[functions[i]->nb_entries * 2 - 1];
+
+	double start = SDLAGetTime();
+	for (int i = 0; i < NB_QUERY_REPEATS; i++)
+	{
+		for (int j = 0; j < nb_functions; j++)
+			u_single[j] = functions[j]->GetParameterNewtonRaphson(s[j]);
+	}
+	double single_time = SDLAGetTime() - start;
+
+	tCurvePack<2> pack(functions, nb_functions);
+
+	start = SDLAGetTime();
+	for (int i = 0; i < NB_QUERY_REPEATS; i++)
+		pack.GetParameters(s, u_packed);
+	double packed_time = SDLAGetTime() - start;
+
+	float max_error = 0;
+	for (int i = 0; i < nb_functions; i++)
+	{
+		float error = (float)fabs(u_single[i] - u_packed[i]);
+		if (error > max_error)
+			max_error = error;
+	}
+
+	double nb_queries = (double)nb_functions * NB_QUERY_REPEATS;
+	printf("\nOne query per curve:\n");
+	printf("  Per curve  %6.1fns\n", single_time * 1e9 / nb_queries);
+	printf("  Packed     %6.1fns  (max parameter difference %.2g)\n", packed_time * 1e9 / nb_queries, max_error);
+
+	delete [] u_packed;
+	delete [] u_single;
+	delete [] s;
+}
+
+
+// Times one position lookup by arc-length on each curve with each position cache mode,
+// reporting the memory it costs and how far the results stray from the exact positions
+void TimePositions(Function** functions, const int nb_functions)
+{
+	static const char* names[] = { "None", "Positions", "Tangents" };
+
+	float* s = new float[nb_functions];
+	Point<2>* exact = new Point<2>[nb_functions];
+	Point<2>* p = new Point<2>[nb_functions];
+
+	for (int i = 0; i < nb_functions; i++)
+		s[i] = Random() * functions[i]->arc_lengths[functions[i]->nb_entries * 2 - 1];
+
+	printf("\nPosition at arc-length:\n");
+	printf("  Cache         Time  Bytes/curve  Mean error  Max error\n");
+
+	for (int mode = Function::CACHE_NONE; mode <= Function::CACHE_TANGENTS; mode++)
+	{
+		int bytes = 0;
+		for (int i = 0; i < nb_functions; i++)
+		{
+			functions[i]->InitPositionCache(mode);
+			bytes += functions[i]->GetPositionCacheSize();
+		}
+
+		double start = SDLAGetTime();
+		for (int i = 0; i < NB_QUERY_REPEATS; i++)
+		{
+			for (int j = 0; j < nb_functions; j++)
+				p[j] = functions[j]->GetPositionAtArcLength(s[j]);
+		}
+		double time = SDLAGetTime() - start;
+
+		if (mode == Function::CACHE_NONE)
+		{
+			for (int i = 0; i < nb_functions; i++)
+				exact[i] = p[i];
+		}
+
+		// Relative to the length of the curve, as giant curves have giant errors. The few
+		// curves with a cusp between two entries dominate the maximum.
+		double total_error = 0;
+		float max_error = 0;
+		for (int i = 0; i < nb_functions; i++)
+		{
+			float error = p[i].DistanceFrom(exact[i]) / functions[i]->arc_lengths[functions[i]->nb_entries * 2 - 1];
+			total_error += error;
+			if (error > max_error)
+				max_error = error;
+		}
+
+		printf("  %-9s  %6.1fns  %11.0f  %10.2g  %9.2g\n", names[mode],
+			time * 1e9 / ((double)nb_functions * NB_QUERY_REPEATS),
+			(double)bytes / nb_functions, total_error / nb_functions, max_error);
+	}
+
+	for (int i = 0; i < nb_functions; i++)
+		functions[i]->InitPositionCache(Function::CACHE_NONE);
+
+	delete [] p;
+	delete [] exact;
+	delete [] s;
+}
+
+
+// Creates lazy tables for every curve and then queries only one curve in LAZY_USED_EVERY,
+// comparing the time and memory with baking everything up front
+static const int LAZY_USED_EVERY = 20;
+
+void TimeLazy(Function** functions, const int nb_functions, const double serial_time)
+{
+	typedef tLazyTable<2, CubicPolynomial> LazyTable;
+	LazyTable** tables = new LazyTable*[nb_functions];
+
+	double start = SDLAGetTime();
+	for (int i = 0; i < nb_functions; i++)
+		tables[i] = new LazyTable(*functions[i], TABLE_TOLERANCE, TABLE_MAX_DIST);
+	double create_time = SDLAGetTime() - start;
+
+	// Each used curve is walked from end to end
+	start = SDLAGetTime();
+	for (int i = 0; i < nb_functions; i += LAZY_USED_EVERY)
+	{
+		float length = tables[i]->GetLength();
+		for (int j = 0; j < NB_QUERY_REPEATS; j++)
+			tables[i]->GetParameter(length * (float)j / (float)(NB_QUERY_REPEATS - 1));
+	}
+	double query_time = SDLAGetTime() - start;
+
+	int full_bytes = 0, lazy_bytes = 0, nb_refined = 0, nb_intervals = 0;
+	for (int i = 0; i < nb_functions; i++)
+	{
+		full_bytes += functions[i]->nb_entries * 2 * sizeof(float);
+		lazy_bytes += tables[i]->GetMemoryUsage();
+		nb_refined += tables[i]->GetNbRefined();
+		nb_intervals += tables[i]->GetNbIntervals();
+		delete tables[i];
+	}
+
+	printf("\nLazy tables, using one curve in %d:\n", LAZY_USED_EVERY);
+	printf("  Baked up front  %7.2fms  %7dKB\n", serial_time * 1000, full_bytes / 1024);
+	printf("  Lazy            %7.2fms  %7dKB  (%.2fms creating, %d of %d intervals refined)\n",
+		(create_time + query_time) * 1000, lazy_bytes / 1024, create_time * 1000, nb_refined, nb_intervals);
+
+	delete [] tables;
+}
+
+
+int main(int argc, char* argv[])
+{
+	int nb_functions = argc > 1 ? atoi(argv[1]) : 20000;
+	int max_threads = argc > 2 ? atoi(argv[2]) : cSDLAWorkPool::GetNbProcessors();
+
+	if (nb_functions < 1 || max_threads < 1)
+	{
+		printf("BakeBench [nb_curves] [max_threads]\n");
+		return (1);
+	}
+
+	// Everything is built from the same curves
+	srand(1);
+	Function** reference = CreateFunctions(nb_functions);
+	srand(1);
+	Function** functions = CreateFunctions(nb_functions);
+
+	// Baseline is one InitTableAdaptiveGaussian after another with no pool at all
+	double start = SDLAGetTime();
+	for (int i = 0; i < nb_functions; i++)
+		reference[i]->InitTableAdaptiveGaussian(TABLE_TOLERANCE, TABLE_MAX_DIST);
+	double serial_time = SDLAGetTime() - start;
+
+	int nb_entries = 0;
+	for (int i = 0; i < nb_functions; i++)
+		nb_entries += reference[i]->nb_entries;
+
+	printf("%d curves, %d table entries\n", nb_functions, nb_entries);
+	printf("Serial: %.2fms\n\n", serial_time * 1000);
+	printf("Threads    Time   Speedup  Efficiency  Pieces  Stolen  Max error\n");
+
+	for (int nb_threads = 1; nb_threads <= max_threads; nb_threads++)
+	{
+		cSDLAWorkPool pool(nb_threads);
+		tBulkBaker<2, CubicPolynomial> baker(&pool);
+
+		double best_time = 0;
+		for (int i = 0; i < NB_REPEATS; i++)
+		{
+			start = SDLAGetTime();
+			baker.Bake(functions, nb_functions, TABLE_TOLERANCE, TABLE_MAX_DIST);
+			double time = SDLAGetTime() - start;
+
+			if (i == 0 || time < best_time)
+				best_time = time;
+		}
+
+		double speedup = serial_time / best_time;
+		printf("%7d  %6.2fms  %6.2fx  %9.0f%%  %6d  %6d  %9.2g\n",
+			nb_threads, best_time * 1000, speedup, 100 * speedup / nb_threads,
+			baker.GetNbPieces(), pool.GetNbStolen(),
+			CompareLengths(functions, reference, nb_functions));
+	}
+
+	TimeQueries(functions, nb_functions);
+	TimePositions(functions, nb_functions);
+	TimeLazy(functions, nb_functions, serial_time);
+
+	ReleaseFunctions(functions, nb_functions);
+	ReleaseFunctions(reference, nb_functions);
+
+	return (0);
+}
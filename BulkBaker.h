@@ -0,0 +1,212 @@
+#ifndef	_INCLUDED_BULKBAKER_H
+#define	_INCLUDED_BULKBAKER_H
+
+
+#ifndef	_INCLUDED_SDLAWORKPOOL_H
+	#include <SDLAWorkPool.h>
+#endif
+
+#ifndef	_INCLUDED_FUNCTION_H
+	#include "Function.h"
+#endif
+
+
+// Builds the adaptive Gaussian arc-length tables for a whole set of functions at once,
+// spread over the threads of a work pool. The result for each function is the same as
+// calling InitTableAdaptiveGaussian() on it.
+//
+// Curves much longer than the average share of work per thread are cut into equal
+// parameter ranges which are built separately and then joined, so that a single giant
+// path can't hold everyone else up at the end. Ranges are always a power of two in
+// number so their ends fall where the adaptive subdivision would split anyway, and the
+// only difference from a single build is that the joined table is never coarser than
+// one entry per range.
+template <int N, typename T> class tBulkBaker
+{
+public:
+	// More pieces per thread evens out the load at the cost of a little more joining
+	tBulkBaker(cSDLAWorkPool* pool, const int pieces_per_thread = 4) :
+
+		m_Pool(pool),
+		m_PiecesPerThread(pieces_per_thread),
+		m_NbPieces(0)
+
+	{
+	}
+
+
+	void Bake(tFunction<N, T>** functions, const int nb_functions, const float tolerance, const float max_dist)
+	{
+		// Work out how many pieces each curve gets from its length
+		int* nb_splits = new int[nb_functions];
+		float* lengths = new float[nb_functions];
+		float total_length = 0;
+		for (int i = 0; i < nb_functions; i++)
+		{
+			lengths[i] = functions[i]->GaussianQuadrature(0, 1);
+			total_length += lengths[i];
+		}
+
+		float piece_length = total_length / (float)(m_Pool->GetNbThreads() * m_PiecesPerThread);
+
+		m_NbPieces = 0;
+		int nb_joins = 0;
+		for (int i = 0; i < nb_functions; i++)
+		{
+			nb_splits[i] = 1;
+			while (nb_splits[i] < MAX_SPLITS && lengths[i] > piece_length * (float)nb_splits[i])
+				nb_splits[i] *= 2;
+
+			m_NbPieces += nb_splits[i];
+			if (nb_splits[i] > 1)
+				nb_joins++;
+		}
+
+		// Create the jobs building each range of each curve, and the jobs that join ranges
+		// back together for the curves that were split
+		Piece* pieces = new Piece[m_NbPieces];
+		Join* joins = new Join[nb_joins];
+		cSDLAJob** jobs = new cSDLAJob*[m_NbPieces];
+
+		Piece* piece = pieces;
+		Join* join = joins;
+		for (int i = 0; i < nb_functions; i++)
+		{
+			if (nb_splits[i] > 1)
+			{
+				join->function = functions[i];
+				join->pieces = piece;
+				join->nb_pieces = nb_splits[i];
+				join++;
+			}
+
+			for (int j = 0; j < nb_splits[i]; j++, piece++)
+			{
+				piece->function = functions[i];
+				piece->u0 = (float)j / (float)nb_splits[i];
+				piece->u1 = (float)(j + 1) / (float)nb_splits[i];
+				piece->tolerance = tolerance;
+				piece->max_dist = max_dist;
+				piece->is_whole = nb_splits[i] == 1;
+				piece->table = 0;
+				piece->nb_entries = 0;
+			}
+		}
+
+		for (int i = 0; i < m_NbPieces; i++)
+			jobs[i] = &pieces[i];
+		m_Pool->Run(jobs, m_NbPieces);
+
+		for (int i = 0; i < nb_joins; i++)
+			jobs[i] = &joins[i];
+		m_Pool->Run(jobs, nb_joins);
+
+		delete [] jobs;
+		delete [] joins;
+		delete [] pieces;
+		delete [] lengths;
+		delete [] nb_splits;
+	}
+
+
+	// Number of separately built ranges in the last bake
+	int GetNbPieces(void) const
+	{
+		return (m_NbPieces);
+	}
+
+
+private:
+	enum
+	{
+		// Most ranges a single curve is cut into
+		MAX_SPLITS = 64
+	};
+
+
+	struct Piece : public cSDLAJob
+	{
+		void Execute(const int)
+		{
+			table = function->BuildTableAdaptiveGaussian(u0, u1, tolerance, max_dist, nb_entries);
+
+			// Nothing to join so the table can go straight in
+			if (is_whole)
+			{
+				delete [] function->arc_lengths;
+				function->arc_lengths = table;
+				function->nb_entries = nb_entries;
+				function->UpdatePositionCache();
+				table = 0;
+			}
+		}
+
+		tFunction<N, T>*	function;
+
+		// Parameter range to build and the settings to build it with
+		float	u0, u1;
+		float	tolerance;
+		float	max_dist;
+
+		// Set when the range covers the whole curve
+		bool	is_whole;
+
+		// Table built for the range, with arc-lengths starting at zero
+		float*	table;
+		int		nb_entries;
+	};
+
+
+	struct Join : public cSDLAJob
+	{
+		void Execute(const int)
+		{
+			// Each range after the first repeats the last entry of the one before
+			int count = 1;
+			for (int i = 0; i < nb_pieces; i++)
+				count += pieces[i].nb_entries - 1;
+
+			float* table = new float[count * 2];
+			table[0] = 0;
+			table[1] = 0;
+
+			// Copy all entries after the first of each range, offsetting the arc-lengths
+			// by the length of everything before
+			int entry = 1;
+			for (int i = 0; i < nb_pieces; i++)
+			{
+				float offset = table[entry * 2 - 1];
+				const float* src = pieces[i].table;
+
+				for (int j = 1; j < pieces[i].nb_entries; j++, entry++)
+				{
+					table[entry * 2 + 0] = src[j * 2 + 0];
+					table[entry * 2 + 1] = src[j * 2 + 1] + offset;
+				}
+
+				delete [] pieces[i].table;
+				pieces[i].table = 0;
+			}
+
+			delete [] function->arc_lengths;
+			function->arc_lengths = table;
+			function->nb_entries = count;
+			function->UpdatePositionCache();
+		}
+
+		tFunction<N, T>*	function;
+
+		// Consecutive ranges of the function in order
+		Piece*	pieces;
+		int		nb_pieces;
+	};
+
+
+	cSDLAWorkPool*	m_Pool;
+
+	int		m_PiecesPerThread;
+	int		m_NbPieces;
+};
+
+
+#endif	/* _INCLUDED_BULKBAKER_H */
@@ -2,16 +2,28 @@
 #include "ComputerAnimation.h"
 #include "Colours.h"
 #include "Function.h"
+#include "PrimitiveBatch.h"
 #include "SDLAFont.h"
+#include "SDLAProfiler.h"
+#include "SDLARenderer.h"
 #include <cmath>
 #include <cstdlib>
 #include <ctime>
 #include <cstdarg>
+#include <cstring>
 
 
 static const float PI = 3.1415926f;
 
 
+// Arc-length covered per second by the white ring
+static const float SPEED = 0.6f;
+
+// Adaptive gaussian table settings, no danger of under-sampling with newton-raphson
+static const float TABLE_TOLERANCE = 1e-6f;
+static const float TABLE_MAX_DIST = 0.5f;
+
+
 namespace
 {
 	template <typename T> const T& min(const T& a, const T& b)
@@ -20,44 +32,28 @@ namespace
 	}
 
 
-	struct CubicPolynomial
+	template <typename T> const T& max(const T& a, const T& b)
 	{
-		float	a, b, c, d;
-
-		float P(const float u) const
-		{
-			float u2 = u * u;
-			float u3 = u2 * u;
-			return (a * u3 + b * u2 + c * u + d);
-		}
+		return (a > b ? a : b);
+	}
 
-		
-		float D1(const float u) const
-		{
-			// First differential function
-			float _a = 3 * a;
-			float _b = 2 * b;
 
-			// Evaluate it
-			return (_a * u * u + _b * u + c);
-		}
+	inline float Random(void)
+	{
+		return (rand() / (float)RAND_MAX);
+	}
 
 
-		float D2(const float u) const
+	void RandomCurve(CubicPolynomial* curve)
+	{
+		// Generate random cubic co-efficients
+		for (int i = 0; i < 2; i++)
 		{
-			// Second differential function
-			float _a = 3 * 2 * a;
-			float _b = 2 * b;
-
-			// Evaluate it
-			return (_a * u + _b);
+			curve[i].a = Random() - 0.5f;
+			curve[i].b = Random() - 0.5f;
+			curve[i].c = Random() - 0.5f;
+			curve[i].d = Random() - 0.5f;
 		}
-	};
-
-
-	inline float Random(void)
-	{
-		return (rand() / (float)RAND_MAX);
 	}
 
 
@@ -82,87 +78,310 @@ namespace
 
 		return (s / f);
 	}
+
+
+	struct SineEase
+	{
+		float operator () (const float t) const
+		{
+			return (EaseSine(t));
+		}
+	};
+
+
+	struct SineSegmentsEase
+	{
+		SineSegmentsEase(const float _k1, const float _k2) : k1(_k1), k2(_k2) { }
+
+		float operator () (const float t) const
+		{
+			return (EaseSineSegments(t, k1, k2));
+		}
+
+		float	k1, k2;
+	};
+
+
+	struct Label
+	{
+		// Line the label is written on
+		int		line;
+
+		const char*	text;
+	};
+
+
+	// Labels down the right of the screen with the value of each method written after them
+	const Label g_Labels[] =
+	{
+		{ 0, "Arc-length (Nearest): " },
+		{ 1, "Arc-length (Lerped): " },
+		{ 2, "Parameter (Nearest): " },
+		{ 3, "Parameter (Lerped): " },
+		{ 4, "Trapezoid (Error): " },
+		{ 5, "Trapezoid (Fixed): " },
+		{ 6, "Simpson (Error): " },
+		{ 7, "Romberg: " },
+		{ 8, "Gaussian Quadrature: " },
+		{ 9, "Adaptive Gaussian Quadrature: " },
+		{ 10, "Newton-Raphson Parameter: " },
+		{ 25, "Speed: " }
+	};
+
+	const int NB_LABELS = sizeof(g_Labels) / sizeof(g_Labels[0]);
+
+
+	// Templated on the curve type so that the evaluations inline rather than going through
+	// FunctionBase
+	template <typename F> float* FlattenSegment(const F& f, const float u0, const Point<2>& p0, const float u1, const Point<2>& p1, const float tolerance, const int depth, const int max_depth, float* out)
+	{
+		// Sample the midpoint and quarter points of the segment
+		float u = (u0 + u1) / 2;
+		Point<2> p = f.Position(u);
+		Point<2> pa = f.Position((u0 + u) / 2);
+		Point<2> pb = f.Position((u + u1) / 2);
+
+		// Get the points on the chord at the same parameters
+		Point<2> c, ca, cb;
+		for (int i = 0; i < 2; i++)
+		{
+			c.values[i] = p0.values[i] + (p1.values[i] - p0.values[i]) * 0.5f;
+			ca.values[i] = p0.values[i] + (p1.values[i] - p0.values[i]) * 0.25f;
+			cb.values[i] = p0.values[i] + (p1.values[i] - p0.values[i]) * 0.75f;
+		}
+
+		// Worst distance of the curve from the chord
+		float e = max(p.DistanceFrom(c), max(pa.DistanceFrom(ca), pb.DistanceFrom(cb)));
+
+		// Always split a few times so that the quarter point test has something to work with
+		if (depth < max_depth && (depth < 3 || e > tolerance))
+		{
+			out = FlattenSegment(f, u0, p0, u, p, tolerance, depth + 1, max_depth, out);
+			return (FlattenSegment(f, u, p, u1, p1, tolerance, depth + 1, max_depth, out));
+		}
+
+		// Emit the end of the segment, the start has already been written
+		*out++ = p1.values[0];
+		*out++ = p1.values[1];
+		return (out);
+	}
 };
 
 
 cComputerAnimation::cComputerAnimation(const int width, const int height) :
 
 	cSDLApp(width, height, true),
+	m_Generation(-1),
+	m_U(0),
 	m_S(0),
-	m_U(0)
+	m_RegenerateRequested(0),
+	m_Font(0),
+	m_NbTableLines(0),
+	m_TableGeneration(-1),
+	m_Labels(0),
+	m_ShowProfile(false)
 
 {
-	m_Function = new tFunction<2, CubicPolynomial>(20);
-
 	srand(time(0));
-	Regenerate();
+
+	// First table is built straight away
+	CubicPolynomial curve[2];
+	RandomCurve(curve);
+	m_Function = new tAsyncFunction<2, CubicPolynomial>(curve, TABLE_TOLERANCE, TABLE_MAX_DIST);
+
+	m_NbCurveVerts = 0;
+	m_CurveVerts = new float[MAX_CURVE_VERTS * 2];
+
+	// Nothing has been copied into any of the states yet
+	m_States = new tSDLATripleBuffer<FrameState>;
+	for (int i = 0; i < 3; i++)
+		(*m_States)[i].generation = -1;
+
+	// Static grid matching the visible area
+	m_Batch = new cPrimitiveBatch(m_Renderer);
+	m_Batch->BuildGrid(-1.5f, 1.5f, -1, 1, 0.1f);
+
+	// Give the render loop something to draw before the first step
+	Simulate(0);
+	m_States->Acquire();
+
+	// Arc-length stepping runs at a fixed 60Hz, on its own thread with -threaded
+	SetSimulationStep(1.0f / 60.0f);
 }
 
 
 cComputerAnimation::~cComputerAnimation(void)
 {
+	DeleteText();
 	delete m_Font;
+	delete m_Batch;
+	delete m_States;
+	delete [] m_CurveVerts;
 	delete m_Function;
 }
 
 
-bool cComputerAnimation::ProcessFrame(void)
+void cComputerAnimation::Simulate(const float dt)
 {
-	// Clear screen
-	glClear(GL_COLOR_BUFFER_BIT);
-
-	// No textures for drawing the remaining stuff
-	glBindTexture(GL_TEXTURE_2D, 0);
+	// Pick up any request from the render loop, leaving it until the last one's done
+	if (m_Function->IsRebuilding() == false && SDLAAtomicExchange(&m_RegenerateRequested, 0))
+	{
+		cSDLAScopedTimer timer(m_SimProfiler, "Regenerate");
+		Regenerate();
+	}
 
-	DrawGrid(COLOUR_DGREY);
-	DrawCurve();
+	// Use whichever function is current for the whole step
+	tAsyncFunction<2, CubicPolynomial>::Reader f_ptr(*m_Function);
 
-	// Get the cast function
-	tFunction<2, CubicPolynomial>* f_ptr = static_cast<tFunction<2, CubicPolynomial>*>(m_Function);
+	// Bake everything else once a new function has been published
+	if (f_ptr.GetVersion() != m_Generation)
+	{
+		cSDLAScopedTimer timer(m_SimProfiler, "Bake");
+		Bake(*f_ptr);
+		m_Generation = f_ptr.GetVersion();
+	}
 
-	// Increment arc-length linearly
-	m_S = m_S + 0.01f;
+	// Increment arc-length linearly with time
+	float step = SPEED * dt;
+	m_S = m_S + step;
 	if (m_S >= f_ptr->L(0, 1)) m_S = 0;
 
 	// Get the parameter value at the current arc-length
 	m_U = f_ptr->GetParameterNewtonRaphson(m_S);
 
-	Point<2> p = m_Function->P(m_U);
-	DrawRing(p.values[0], p.values[1], 0.02f, 0.1f, COLOUR_WHITE);
+	// Time each of the methods on its own
+	float values[NB_VALUES];
+	{
+		cSDLAScopedTimer timer(m_SimProfiler, "Methods");
+		{ cSDLAScopedTimer t(m_SimProfiler, "Arc-length (Nearest)");		values[0] = f_ptr->GetArcLengthNearestAdaptive(m_U); }
+		{ cSDLAScopedTimer t(m_SimProfiler, "Arc-length (Lerped)");			values[1] = f_ptr->GetArcLengthLerpedAdaptive(m_U); }
+		{ cSDLAScopedTimer t(m_SimProfiler, "Parameter (Nearest)");			values[2] = f_ptr->GetParameterNearest(m_S); }
+		values[3] = m_U;
+		{ cSDLAScopedTimer t(m_SimProfiler, "Trapezoid (Error)");			values[4] = f_ptr->IntegrateTrapezoidError(0, m_U, 5); }
+		{ cSDLAScopedTimer t(m_SimProfiler, "Trapezoid (Fixed)");			values[5] = f_ptr->IntegrateTrapezoidFixed(0, m_U, 10); }
+		{ cSDLAScopedTimer t(m_SimProfiler, "Simpson (Error)");				values[6] = f_ptr->IntegrateSimpsonError(0, m_U, 5); }
+		{ cSDLAScopedTimer t(m_SimProfiler, "Romberg");						values[7] = f_ptr->IntegrateRomberg(0, m_U); }
+		{ cSDLAScopedTimer t(m_SimProfiler, "Gaussian Quadrature");			values[8] = f_ptr->GaussianQuadrature(0, m_U); }
+		{ cSDLAScopedTimer t(m_SimProfiler, "Adaptive Gaussian");			values[9] = f_ptr->GetArcLengthAdaptiveGaussian(m_U); }
+		{ cSDLAScopedTimer t(m_SimProfiler, "Newton-Raphson Parameter");	values[10] = f_ptr->GetParameterNewtonRaphson(m_S); }
+	}
+
+	// Distance covered this step
+	Point<2> p = f_ptr->Position(m_U);
+	Point<2> p0 = f_ptr->Position(f_ptr->GetParameterNewtonRaphson(m_S - step));
+	values[11] = p0.DistanceFrom(p);
+
+	PublishState(*f_ptr, values);
+}
+
+
+void cComputerAnimation::PublishState(const tFunction<2, CubicPolynomial>& f, const float* values)
+{
+	FrameState& state = m_States->GetBack();
+
+	// The curve and table only need copying when this state last saw an older curve
+	if (state.generation != m_Generation)
+	{
+		state.generation = m_Generation;
+		state.nb_curve_verts = m_NbCurveVerts;
+		memcpy(state.curve_verts, m_CurveVerts, m_NbCurveVerts * 2 * sizeof(float));
+
+		state.nb_table_entries = f.nb_entries;
+		memcpy(state.table, f.arc_lengths, min((int)MAX_TABLE_LINES - 1, f.nb_entries) * 2 * sizeof(float));
+	}
+
+	Point<2> p = f.Position(m_U);
+	state.white[0] = p.values[0];
+	state.white[1] = p.values[1];
+
+	// Eased rings use the time -> parameter mappings baked in Regenerate
+	float t = m_S / f.L(0, 1);
+	Point<2> pr = f.Position(m_EaseSine.GetParameter(t));
+	state.red[0] = pr.values[0];
+	state.red[1] = pr.values[1];
 
+	Point<2> pg = f.Position(m_EaseSineSegments.GetParameter(t));
+	state.green[0] = pg.values[0];
+	state.green[1] = pg.values[1];
+
+	memcpy(state.values, values, sizeof(state.values));
+	m_SimProfiler->GetSummary(state.sim_profile);
+
+	m_States->Publish();
+}
+
+
+bool cComputerAnimation::ProcessFrame(void)
+{
+	// Latest state from the simulation, which may be the same as last frame
+	m_States->Acquire();
+	const FrameState& state = m_States->GetFront();
+
+	// Lay out the table dump again for a new curve
+	if (m_TableGeneration != state.generation)
+	{
+		cSDLAScopedTimer timer(m_Profiler, "Table text");
+		UpdateTableText(state);
+	}
+
+	// Clear screen
+	m_Renderer->Clear(GL_COLOR_BUFFER_BIT);
+
+	// No textures for drawing the remaining stuff
+	m_Renderer->BindTexture(GL_TEXTURE_2D, 0);
+
+	{
+		cSDLAScopedTimer timer(m_Profiler, "Grid and curve");
+		DrawGrid(COLOUR_DGREY);
+		DrawCurve(state);
+	}
+
+	DrawRing(state.white[0], state.white[1], 0.02f, 0.1f, COLOUR_WHITE);
+	DrawRing(state.red[0], state.red[1], 0.02f, 0.07f, COLOUR_RED);
+	DrawRing(state.green[0], state.green[1], 0.02f, 0.05f, COLOUR_GREEN);
+
+	// The simulation does the work
 	if (m_KeysReleased[SDLK_SPACE])
-		Regenerate();
+		SDLAAtomicExchange(&m_RegenerateRequested, 1);
 
-	int i;
-	for (i = 0; i < min(21, f_ptr->nb_entries); i++)
-		WriteText(-1.25f, i, "%d: %.2f -> %.4f", i, f_ptr->arc_lengths[i * 2 + 0], f_ptr->arc_lengths[i * 2 + 1]);
-	WriteText(-1.25f, i, "(nb_entries = %d)", f_ptr->nb_entries);
-
-	WriteText(0.2f, 0, "Arc-length (Nearest): %f", f_ptr->GetArcLengthNearestAdaptive(m_U));
-	WriteText(0.2f, 1, "Arc-length (Lerped): %f", f_ptr->GetArcLengthLerpedAdaptive(m_U));
-	WriteText(0.2f, 2, "Parameter (Nearest): %f", f_ptr->GetParameterNearest(m_S));
-	WriteText(0.2f, 3, "Parameter (Lerped): %f", m_U);
-	WriteText(0.2f, 4, "Trapezoid (Error): %f", f_ptr->IntegrateTrapezoidError(0, m_U, 5));
-	WriteText(0.2f, 5, "Trapezoid (Fixed): %f", f_ptr->IntegrateTrapezoidFixed(0, m_U, 10));
-	WriteText(0.2f, 6, "Simpson (Error): %f", f_ptr->IntegrateSimpsonError(0, m_U, 5));
-	WriteText(0.2f, 7, "Romberg: %f", f_ptr->IntegrateRomberg(0, m_U));
-	WriteText(0.2f, 8, "Gaussian Quadrature: %f", f_ptr->GaussianQuadrature(0, m_U));
-	WriteText(0.2f, 9, "Adaptive Gaussian Quadrature: %f", f_ptr->GetArcLengthAdaptiveGaussian(m_U));
-	WriteText(0.2f, 10, "Newton-Raphson Parameter: %f", f_ptr->GetParameterNewtonRaphson(m_S));
-
-	Point<2> p0 = m_Function->P(f_ptr->GetParameterNewtonRaphson(m_S - 0.01f));
-	WriteText(0.2f, 25, "Speed: %f", p0.DistanceFrom(p));
-
-	float l = f_ptr->L(0, 1);
-	float s = EaseSine(m_S / l) * l;
-	float u = f_ptr->GetParameterNewtonRaphson(s);
-	Point<2> pr = m_Function->P(u);
-	DrawRing(pr.values[0], pr.values[1], 0.02f, 0.07f, COLOUR_RED);
-
-	s = EaseSineSegments(m_S / l, 0.2f, 0.8f) * l;
-	u = f_ptr->GetParameterNewtonRaphson(s);
-	Point<2> pg = m_Function->P(u);
-	DrawRing(pg.values[0], pg.values[1], 0.02f, 0.05f, COLOUR_GREEN);
+	if (m_KeysReleased[SDLK_p])
+		m_ShowProfile = !m_ShowProfile;
+
+	{
+		cSDLAScopedTimer timer(m_Profiler, "Text");
+
+		// Collect all the text so that it's drawn with one call per font page
+		m_Font->BeginBatch();
+
+		// The table dump and labels are only laid out again when they change, the profile
+		// takes the place of the table when it's showing
+		int i;
+		if (m_ShowProfile)
+		{
+			// The simulation's profile comes with its state, the profiler itself may be
+			// mid-update on its own thread
+			float y = m_Profiler->DrawHUD(m_Font, -1.25f, 0.8f);
+			cSDLAProfiler::DrawHUD(state.sim_profile, m_Font, -1.25f, y);
+		}
+		else
+		{
+			for (i = 0; i < m_NbTableLines; i++)
+				m_TableText[i]->Draw();
+		}
+		for (i = 0; i < NB_LABELS; i++)
+		{
+			m_Labels[i]->Draw();
+			WriteValue(i, state.values[i]);
+		}
+
+		m_Font->EndBatch();
+	}
+
+	// Submit all the markers for this frame
+	{
+		cSDLAScopedTimer timer(m_Profiler, "Markers");
+		m_Batch->Flush();
+	}
 
 	return (true);
 }
@@ -170,44 +389,45 @@ bool cComputerAnimation::ProcessFrame(void)
 
 void cComputerAnimation::BeforeSwitch(void)
 {
+	DeleteText();
 	delete m_Font;
+	m_Font = 0;
 }
 
 
 void cComputerAnimation::AfterSwitch(void)
 {
-	glDisable(GL_DEPTH_TEST);
+	m_Renderer->Disable(GL_DEPTH_TEST);
 
 	// Standard SDL clear colour
-	glClearColor(0, 0, 0, 1);
+	m_Renderer->ClearColor(0, 0, 0, 1);
 
 	m_Font = CreateFont("ArialItalic.fdb");
+
+	// Lay out all the static text with the new font
+	CreateText();
+	UpdateTableText(m_States->GetFront());
 }
 
 
 void cComputerAnimation::Regenerate(void)
 {
-	// Cast to function type
-	tFunction<2, CubicPolynomial>* f_ptr = static_cast<tFunction<2, CubicPolynomial>*>(m_Function);
+	CubicPolynomial curve[2];
+	RandomCurve(curve);
 
-	// Generate random cubic co-efficients
-	for (int i = 0; i < 2; i++)
-	{
-		f_ptr->curve[i].a = Random() - 0.5f;
-		f_ptr->curve[i].b = Random() - 0.5f;
-		f_ptr->curve[i].c = Random() - 0.5f;
-		f_ptr->curve[i].d = Random() - 0.5f;
-	}
+	// The table is built on a worker, the current one carries on being used until it's done
+	m_Function->Rebuild(curve, TABLE_TOLERANCE, TABLE_MAX_DIST);
+}
 
-	// Basic non-adaptive initialisation
-	//f_ptr->InitTable();
 
-	// Chance of large under-sampling with linear distance based method so bring in
-	// quite a small maximum distance of subdivision
-	//f_ptr->InitTableAdaptive(0.00001f, 0.05f);
+void cComputerAnimation::Bake(const tFunction<2, CubicPolynomial>& f)
+{
+	// Bake the eased timing of the red and green rings against the new table
+	m_EaseSine.Init(f, SineEase(), 1e-4f, 0.125f);
+	m_EaseSineSegments.Init(f, SineSegmentsEase(0.2f, 0.8f), 1e-4f, 0.125f);
 
-	// No danger of under-sampling with newton-raphson
-	f_ptr->InitTableAdaptiveGaussian(1e-6f, 0.5f);
+	// Around a quarter of a pixel at 640x480
+	BuildCurveMesh(f, 0.001f);
 
 	m_S = 0;
 }
@@ -227,126 +447,107 @@ float cComputerAnimation::YPos(const int y) const
 
 void cComputerAnimation::DrawCircle(const float x, const float y, const float radius, const int colour)
 {
-	// Set colour
-	glColor3fv(g_Colours[colour]);
-
-	// Position the circle
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-	glTranslatef(x, y, 1);
-
-	// Subdivision parameters
-	static const int NB_SUBS = 32;
-	static const float INCREMENT = 6.2824f / (NB_SUBS - 1);
-
-	// Begin circle triangle fan
-	glBegin(GL_TRIANGLE_FAN);
-	glVertex3f(0, 0, 0);
-
-	for (int i = 0; i < NB_SUBS; i++)
-	{
-		// Increment over the circumference
-		float t = INCREMENT * i;
-		float x = (float)cos(t) * radius;
-		float y = (float)sin(t) * radius;
-
-		// Plot the point
-		glVertex3f(x, y, 0);
-	}
-
-	glEnd();
+	m_Batch->AddCircle(x, y, radius, g_Colours[colour]);
 }
 
 
 void cComputerAnimation::DrawRing(const float x, const float y, const float inner_radius, const float outer_radius, const int colour)
 {
-	// Set colour
-	glColor3fv(g_Colours[colour]);
+	m_Batch->AddRing(x, y, inner_radius, outer_radius, g_Colours[colour]);
+}
 
-	// Position the ring
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
-	glTranslatef(x, y, 1);
 
-	// Subdivision parameters
-	static const int NB_SUBS = 32;
-	static const float INCREMENT = 6.2824f / (NB_SUBS - 1);
+void cComputerAnimation::DrawCurve(const FrameState& state)
+{
+	// Draw the start and end points
+	const float* a = &state.curve_verts[0];
+	const float* b = &state.curve_verts[(state.nb_curve_verts - 1) * 2];
+	DrawCircle(a[0], a[1], 0.02f, COLOUR_YELLOW);
+	DrawCircle(b[0], b[1], 0.02f, COLOUR_YELLOW);
 
-	// Begin ring triangle strip
-	glBegin(GL_TRIANGLE_STRIP);
+	// Set colour
+	m_Renderer->Color3fv(g_Colours[COLOUR_YELLOW]);
 
-	for (int i = 0; i < NB_SUBS; i++)
-	{
-		// Increment around circle
-		float t = INCREMENT * i;
+	// Position in world space
+	m_Renderer->MatrixMode(GL_MODELVIEW);
+	m_Renderer->LoadIdentity();
+
+	// Draw the cached curve connecting the end points in one go
+	m_Renderer->EnableClientState(GL_VERTEX_ARRAY);
+	m_Renderer->VertexPointer(2, GL_FLOAT, 0, state.curve_verts);
+	m_Renderer->DrawArrays(GL_LINE_STRIP, 0, state.nb_curve_verts);
+	m_Renderer->DisableClientState(GL_VERTEX_ARRAY);
+}
 
-		// Get inner point
-		float x0 = (float)cos(t) * inner_radius;
-		float y0 = (float)sin(t) * inner_radius;
 
-		// Get outer point
-		float x1 = (float)cos(t) * outer_radius;
-		float y1 = (float)sin(t) * outer_radius;
+void cComputerAnimation::BuildCurveMesh(const tFunction<2, CubicPolynomial>& f, const float tolerance)
+{
+	// Start point is written up-front, each flattened segment then adds its end point
+	Point<2> p0 = f.Position(0);
+	Point<2> p1 = f.Position(1);
+	m_CurveVerts[0] = p0.values[0];
+	m_CurveVerts[1] = p0.values[1];
+
+	// Subdivide until the line strip is within tolerance of the curve
+	float* end = FlattenSegment(f, 0, p0, 1, p1, tolerance, 0, MAX_FLATTEN_DEPTH, m_CurveVerts + 2);
+	m_NbCurveVerts = (end - m_CurveVerts) / 2;
+}
 
-		// Build the strip
-		glVertex3f(x1, y1, 0);
-		glVertex3f(x0, y0, 0);
-	}
 
-	glEnd();
+void cComputerAnimation::DrawGrid(const int colour)
+{
+	m_Batch->DrawGrid(g_Colours[colour]);
 }
 
 
-void cComputerAnimation::DrawCurve(void)
+void cComputerAnimation::CreateText(void)
 {
-	// Draw the start and end points
-	Point<2> a = m_Function->P(0);
-	Point<2> b = m_Function->P(1);
-	DrawCircle(a.values[0], a.values[1], 0.02f, COLOUR_YELLOW);
-	DrawCircle(b.values[0], b.values[1], 0.02f, COLOUR_YELLOW);
+	int i;
 
-	// Position in world space
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
+	for (i = 0; i < MAX_TABLE_LINES; i++)
+		m_TableText[i] = new cSDLAText(m_Font);
 
-	// Draw a curve connecting the end points
-	glBegin(GL_LINES);
-	for (float i = 0; i < 1; i += 0.01f)
+	// The labels never change
+	m_Labels = new cSDLAText*[NB_LABELS];
+	for (i = 0; i < NB_LABELS; i++)
 	{
-		Point<2> a = m_Function->P(i);
-		Point<2> b = m_Function->P(i + 0.01f);
-		glVertex3f(a.values[0], a.values[1], 0);
-		glVertex3f(b.values[0], b.values[1], 0);
+		m_Labels[i] = new cSDLAText(m_Font);
+		SetText(m_Labels[i], 0.2f, g_Labels[i].line, g_Labels[i].text);
 	}
-	glEnd();
 }
 
 
-void cComputerAnimation::DrawGrid(const int colour)
+void cComputerAnimation::DeleteText(void)
 {
-	// Set colour
-	glColor3fv(g_Colours[colour]);
+	// Not created yet
+	if (m_Labels == 0)
+		return;
 
-	// Position in world space
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
+	int i;
+	for (i = 0; i < NB_LABELS; i++)
+		delete m_Labels[i];
+	delete [] m_Labels;
+	m_Labels = 0;
+
+	for (i = 0; i < MAX_TABLE_LINES; i++)
+		delete m_TableText[i];
+	m_NbTableLines = 0;
+}
 
-	glBegin(GL_LINES);
-	for (float i = -1.5f; i < 1.5f; i += 0.1f)
-	{
-		glVertex3f(i, 1, 0);
-		glVertex3f(i, -1, 0);
-	}
-	for (float j = -1; j < 1; j += 0.1f)
-	{
-		glVertex3f(-1.5f, j, 0);
-		glVertex3f(1.5f, j, 0);
-	}
-	glEnd();
+
+void cComputerAnimation::UpdateTableText(const FrameState& state)
+{
+	int i;
+	for (i = 0; i < min((int)MAX_TABLE_LINES - 1, state.nb_table_entries); i++)
+		SetText(m_TableText[i], -1.25f, i, "%d: %.2f -> %.4f", i, state.table[i * 2 + 0], state.table[i * 2 + 1]);
+	SetText(m_TableText[i], -1.25f, i, "(nb_entries = %d)", state.nb_table_entries);
+
+	m_NbTableLines = i + 1;
+	m_TableGeneration = state.generation;
 }
 
 
-void cComputerAnimation::WriteText(const float x, const int y, const char* format, ...)
+void cComputerAnimation::SetText(cSDLAText* text, const float x, const int y, const char* format, ...)
 {
 	va_list	arglist;
 	char	buffer[512];
@@ -356,6 +557,16 @@ void cComputerAnimation::WriteText(const float x, const int y, const char* forma
 	vsprintf(buffer, format, arglist);
 	va_end(arglist);
 
-	// Write the text
-	m_Font->WriteText(buffer, x, 0.8f - m_Font->GetLineHeight() * y, 1);
-}
\ No newline at end of file
+	// Only laid out if it's changed
+	text->Set(buffer, x, 0.8f - m_Font->GetLineHeight() * y, 1);
+}
+
+
+void cComputerAnimation::WriteValue(const int label, const float value)
+{
+	char	buffer[32];
+
+	// Write the value just after its label
+	sprintf(buffer, "%f", value);
+	m_Font->WriteText(buffer, 0.2f + m_Labels[label]->GetWidth(), 0.8f - m_Font->GetLineHeight() * g_Labels[label].line, 1);
+}
@@ -98,12 +98,20 @@ SOURCE=.\ComputerAnimation.cpp
 
 SOURCE=.\Main.cpp
 # End Source File
+# Begin Source File
+
+SOURCE=.\PrimitiveBatch.cpp
+# End Source File
 # End Group
 # Begin Group "Header Files"
 
 # PROP Default_Filter "h;hpp;hxx;hm;inl"
 # Begin Source File
 
+SOURCE=.\AsyncFunction.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Colours.h
 # End Source File
 # Begin Source File
@@ -112,6 +120,14 @@ SOURCE=.\ComputerAnimation.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\CubicPolynomial.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\CurveEvaluation.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\Function.h
 # End Source File
 # Begin Source File
@@ -122,6 +138,14 @@ SOURCE=.\FunctionBase.h
 
 SOURCE=.\Point.h
 # End Source File
+# Begin Source File
+
+SOURCE=.\PrimitiveBatch.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\TimingCurve.h
+# End Source File
 # End Group
 # Begin Group "Resource Files"
 
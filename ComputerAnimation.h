@@ -7,10 +7,30 @@
 	#include <SDLApp.h>
 #endif
 
-#ifndef	_INCLUDED_FUNCTIONBASE_H
-	#include "FunctionBase.h"
+#ifndef	_INCLUDED_ASYNCFUNCTION_H
+	#include "AsyncFunction.h"
 #endif
 
+#ifndef	_INCLUDED_CUBICPOLYNOMIAL_H
+	#include "CubicPolynomial.h"
+#endif
+
+#ifndef	_INCLUDED_TIMINGCURVE_H
+	#include "TimingCurve.h"
+#endif
+
+#ifndef	_INCLUDED_SDLATRIPLEBUFFER_H
+	#include <SDLATripleBuffer.h>
+#endif
+
+#ifndef	_INCLUDED_SDLAPROFILER_H
+	#include <SDLAProfiler.h>
+#endif
+
+
+class cPrimitiveBatch;
+class cSDLAText;
+
 
 class cComputerAnimation : public cSDLApp
 {
@@ -20,27 +40,114 @@ public:
 	~cComputerAnimation(void);
 
 private:
+	enum
+	{
+		// Deepest level of subdivision when flattening the curve
+		MAX_FLATTEN_DEPTH = 12,
+
+		// Enough space for the deepest possible subdivision
+		MAX_CURVE_VERTS = (1 << MAX_FLATTEN_DEPTH) + 1,
+
+		// Lines of the table dump, the last shows the number of entries
+		MAX_TABLE_LINES = 22,
+
+		// Number of methods plus the speed
+		NB_VALUES = 12
+	};
+
+	// Everything the render loop needs from a simulation step
+	struct FrameState
+	{
+		// Changes every time the curve is regenerated
+		int		generation;
+
+		// Curve flattened to a line strip
+		int		nb_curve_verts;
+		float	curve_verts[MAX_CURVE_VERTS * 2];
+
+		// Start of the arc-length table for the dump
+		int		nb_table_entries;
+		float	table[(MAX_TABLE_LINES - 1) * 2];
+
+		// Positions of the white, red and green rings
+		float	white[2], red[2], green[2];
+
+		// Result of each method
+		float	values[NB_VALUES];
+
+		// Simulation timings, as the profiler itself belongs to the simulation thread
+		cSDLAProfiler::Summary	sim_profile;
+	};
+
 	bool	ProcessFrame(void);
 	void	BeforeSwitch(void);
 	void	AfterSwitch(void);
+	void	Simulate(const float dt);
 
 	float	XPos(const int x) const;
 	float	YPos(const int y) const;
 	void	DrawCircle(const float x, const float y, const float radius, const int colour);
 	void	DrawRing(const float x, const float y, const float inner_radius, const float outer_radius, const int colour);
-	void	DrawCurve(void);
+	void	DrawCurve(const FrameState& state);
+	void	BuildCurveMesh(const tFunction<2, CubicPolynomial>& f, const float tolerance);
 	void	DrawGrid(const int colour);
 
 	void	Regenerate(void);
+	void	Bake(const tFunction<2, CubicPolynomial>& f);
+	void	PublishState(const tFunction<2, CubicPolynomial>& f, const float* values);
 
-	void	WriteText(const float x, const int y, const char* format, ...);
+	void	CreateText(void);
+	void	DeleteText(void);
+	void	UpdateTableText(const FrameState& state);
+	void	SetText(cSDLAText* text, const float x, const int y, const char* format, ...);
+	void	WriteValue(const int label, const float value);
 
-	FunctionBase<2>* m_Function;
+	// --- Owned by the simulation ---
 
-	cSDLAFont*	m_Font;
+	// Rebuilt in the background when the user asks for a new curve
+	tAsyncFunction<2, CubicPolynomial>*	m_Function;
+
+	// Baked ease functions for the red and green rings
+	TimingCurve	m_EaseSine;
+	TimingCurve	m_EaseSineSegments;
+
+	// Curve flattened to a line strip, rebuilt whenever the curve changes
+	int		m_NbCurveVerts;
+	float*	m_CurveVerts;
+
+	// Version of the function everything above was baked for
+	int		m_Generation;
 
 	float	m_U;
 	float	m_S;
+
+	// --- Shared ---
+
+	// Hands a copy of the simulation to the render loop each step
+	tSDLATripleBuffer<FrameState>*	m_States;
+
+	// Set by the render loop when the user asks for a new curve
+	volatile long	m_RegenerateRequested;
+
+	// --- Owned by the render loop ---
+
+	cSDLAFont*	m_Font;
+
+	// Retained text for the table dump, which only changes on regenerate
+	int			m_NbTableLines;
+	cSDLAText*	m_TableText[MAX_TABLE_LINES];
+
+	// Generation of the curve the table dump was laid out for
+	int			m_TableGeneration;
+
+	// Retained labels for the value of each method
+	cSDLAText**	m_Labels;
+
+	// All markers drawn over a frame
+	cPrimitiveBatch*	m_Batch;
+
+	// Show frame timings in place of the table?
+	bool	m_ShowProfile;
 };
 
 
@@ -0,0 +1,220 @@
+#ifndef	_INCLUDED_CUBICPOLYNOMIAL_H
+#define	_INCLUDED_CUBICPOLYNOMIAL_H
+
+
+#ifndef	_INCLUDED_CURVEEVALUATION_H
+	#include "CurveEvaluation.h"
+#endif
+
+
+// One dimension of a cubic curve, P(u) = au^3 + bu^2 + cu + d. The SSE evaluation below
+// relies on the four coefficients being laid out one after the other.
+struct CubicPolynomial
+{
+	float	a, b, c, d;
+
+	float P(const float u) const
+	{
+		float u2 = u * u;
+		float u3 = u2 * u;
+		return (a * u3 + b * u2 + c * u + d);
+	}
+
+
+	float D1(const float u) const
+	{
+		// First differential function
+		float _a = 3 * a;
+		float _b = 2 * b;
+
+		// Evaluate it
+		return (_a * u * u + _b * u + c);
+	}
+
+
+	float D2(const float u) const
+	{
+		// Second differential function
+		float _a = 3 * 2 * a;
+		float _b = 2 * b;
+
+		// Evaluate it
+		return (_a * u + _b);
+	}
+};
+
+
+// Horner's rule for the position, picking up both differentials along the way
+inline void EvaluateComponent(const CubicPolynomial& c, const float u, const int order, float* values)
+{
+	float ab = c.a * u + c.b;
+	float abc = ab * u + c.c;
+	values[0] = abc * u + c.d;
+
+	// 3au^2 + 2bu + c = (au + b)u + c + (2au + b)u
+	if (order > 0)
+		values[1] = abc + (ab + c.a * u) * u;
+
+	// 6au + 2b = 2(au + b) + 4au
+	if (order > 1)
+		values[2] = 2 * (ab + 2 * c.a * u);
+}
+
+
+#ifdef	ARCLENGTH_SSE
+
+// Coefficients of four dimensions starting at the given one, with each register holding
+// one coefficient for all of them. Dimensions past the end of the curve are all zero.
+template <int N> inline void LoadCoefficients(const CubicPolynomial (&curve)[N], const int first, __m128& a, __m128& b, __m128& c, __m128& d)
+{
+	a = first + 0 < N ? _mm_loadu_ps(&curve[first + 0].a) : _mm_setzero_ps();
+	b = first + 1 < N ? _mm_loadu_ps(&curve[first + 1].a) : _mm_setzero_ps();
+	c = first + 2 < N ? _mm_loadu_ps(&curve[first + 2].a) : _mm_setzero_ps();
+	d = first + 3 < N ? _mm_loadu_ps(&curve[first + 3].a) : _mm_setzero_ps();
+
+	// Each register held one dimension, swap them round to one coefficient each
+	_MM_TRANSPOSE4_PS(a, b, c, d);
+}
+
+
+// Overloads of the generic evaluators in CurveEvaluation.h that do four dimensions at a
+// time with Horner's rule
+template <int N> inline void EvaluatePosition(const CubicPolynomial (&curve)[N], const float u, Point<N>& p)
+{
+	__m128 vu = _mm_set1_ps(u);
+
+	for (int i = 0; i < N; i += 4)
+	{
+		__m128 a, b, c, d;
+		LoadCoefficients(curve, i, a, b, c, d);
+
+		__m128 v = _mm_add_ps(_mm_mul_ps(a, vu), b);
+		v = _mm_add_ps(_mm_mul_ps(v, vu), c);
+		v = _mm_add_ps(_mm_mul_ps(v, vu), d);
+		_mm_storeu_ps(p.values + i, v);
+	}
+}
+
+
+template <int N> inline float EvaluateSpeed(const CubicPolynomial (&curve)[N], const float u)
+{
+	__m128 vu = _mm_set1_ps(u);
+	__m128 sum = _mm_setzero_ps();
+
+	for (int i = 0; i < N; i += 4)
+	{
+		__m128 a, b, c, d;
+		LoadCoefficients(curve, i, a, b, c, d);
+
+		// 3au^2 + 2bu + c
+		__m128 v = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(a, _mm_set1_ps(3)), vu), _mm_mul_ps(b, _mm_set1_ps(2)));
+		v = _mm_add_ps(_mm_mul_ps(v, vu), c);
+		sum = _mm_add_ps(sum, _mm_mul_ps(v, v));
+	}
+
+	float speed;
+	_mm_store_ss(&speed, _mm_sqrt_ss(SSEHorizontalSum(sum)));
+	return (speed);
+}
+
+
+// Four parameters at a time, each lane taking a different parameter through all of the
+// dimensions so that one square root does four speeds
+template <int N> inline void EvaluateSpeeds(const CubicPolynomial (&curve)[N], const float* u, float* speeds, const int count)
+{
+	// Coefficients of the first differential, the same in every lane
+	__m128 a[N], b[N], c[N];
+	for (int j = 0; j < N; j++)
+	{
+		a[j] = _mm_set1_ps(3 * curve[j].a);
+		b[j] = _mm_set1_ps(2 * curve[j].b);
+		c[j] = _mm_set1_ps(curve[j].c);
+	}
+
+	for (int i = 0; i < count; i += 4)
+	{
+		// Pad out the last few by repeating the final parameter
+		float tail[4];
+		bool is_tail = count - i < 4;
+		if (is_tail)
+		{
+			for (int j = 0; j < 4; j++)
+				tail[j] = u[i + j < count ? i + j : count - 1];
+		}
+		__m128 vu = _mm_loadu_ps(is_tail ? tail : u + i);
+
+		__m128 sum = _mm_setzero_ps();
+		for (int j = 0; j < N; j++)
+		{
+			// 3au^2 + 2bu + c
+			__m128 v = _mm_add_ps(_mm_mul_ps(a[j], vu), b[j]);
+			v = _mm_add_ps(_mm_mul_ps(v, vu), c[j]);
+			sum = _mm_add_ps(sum, _mm_mul_ps(v, v));
+		}
+
+		if (is_tail)
+		{
+			_mm_storeu_ps(tail, _mm_sqrt_ps(sum));
+			for (int j = 0; i + j < count; j++)
+				speeds[i + j] = tail[j];
+		}
+		else
+			_mm_storeu_ps(speeds + i, _mm_sqrt_ps(sum));
+	}
+}
+
+
+template <int N> inline float EvaluateFused(const CubicPolynomial (&curve)[N], const float u, Point<N>& p, Point<N>& d1)
+{
+	__m128 vu = _mm_set1_ps(u);
+	__m128 sum = _mm_setzero_ps();
+
+	for (int i = 0; i < N; i += 4)
+	{
+		__m128 a, b, c, d;
+		LoadCoefficients(curve, i, a, b, c, d);
+
+		// The derivative shares the first step of Horner's rule with the position:
+		// au + b, then (au + b)u + c, and D1 = (3au + 2b)u + c = (au + b)u + (2au + b)u + c
+		__m128 ab = _mm_add_ps(_mm_mul_ps(a, vu), b);
+		__m128 abc = _mm_add_ps(_mm_mul_ps(ab, vu), c);
+		_mm_storeu_ps(p.values + i, _mm_add_ps(_mm_mul_ps(abc, vu), d));
+
+		__m128 v = _mm_add_ps(abc, _mm_mul_ps(_mm_add_ps(ab, _mm_mul_ps(a, vu)), vu));
+		_mm_storeu_ps(d1.values + i, v);
+		sum = _mm_add_ps(sum, _mm_mul_ps(v, v));
+	}
+
+	float speed;
+	_mm_store_ss(&speed, _mm_sqrt_ss(SSEHorizontalSum(sum)));
+	return (speed);
+}
+
+
+template <int N> inline void EvaluateCurve(const CubicPolynomial (&curve)[N], const float u, const int order, CurveSample<N>& sample)
+{
+	sample.order = order;
+	__m128 vu = _mm_set1_ps(u);
+
+	for (int i = 0; i < N; i += 4)
+	{
+		__m128 a, b, c, d;
+		LoadCoefficients(curve, i, a, b, c, d);
+
+		// Same sharing as the single dimension version
+		__m128 au = _mm_mul_ps(a, vu);
+		__m128 ab = _mm_add_ps(au, b);
+		__m128 abc = _mm_add_ps(_mm_mul_ps(ab, vu), c);
+		_mm_storeu_ps(sample.position.values + i, _mm_add_ps(_mm_mul_ps(abc, vu), d));
+
+		if (order > 0)
+			_mm_storeu_ps(sample.d1.values + i, _mm_add_ps(abc, _mm_mul_ps(_mm_add_ps(ab, au), vu)));
+		if (order > 1)
+			_mm_storeu_ps(sample.d2.values + i, _mm_mul_ps(_mm_set1_ps(2), _mm_add_ps(ab, _mm_add_ps(au, au))));
+	}
+}
+
+#endif
+
+
+#endif	/* _INCLUDED_CUBICPOLYNOMIAL_H */
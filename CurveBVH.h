@@ -0,0 +1,405 @@
+
+#ifndef	_INCLUDED_CURVEBVH_H
+#define	_INCLUDED_CURVEBVH_H
+
+
+#ifndef	_INCLUDED_FUNCTION_H
+	#include "Function.h"
+#endif
+
+
+// Point on a curve closest to some other point
+struct CurveProjection
+{
+	// Parameter and arc-length of the point on the curve
+	float	u;
+	float	s;
+
+	// Distance from the point being projected
+	float	distance;
+};
+
+
+// Finds the point on a curve closest to any point in space, for snapping things to a path
+// or steering them back towards it. A bounding-volume hierarchy is built over the intervals
+// of the curve's arc-length table so that a query only has to look closely at the few
+// intervals that could be nearest, before Newton-Raphson on the squared distance pins down
+// the point within them. Where the distance isn't convex or Newton-Raphson doesn't settle,
+// which is common far from the curve or with long intervals, a bracketed search of the
+// whole interval takes over.
+//
+// Each interval is bounded by the box around its end points, grown in each dimension by how
+// far the curve can bow away from the straight line between them: M * du^2 / 8, where M is
+// the largest second differential in that dimension. The second differential is sampled at
+// the ends and the middle of the interval, which bounds it exactly for cubics since theirs
+// is linear, and gives a close estimate for anything else.
+//
+// The function is referenced rather than copied, so the hierarchy has to be created again
+// if the curve or its table change.
+template <int N, typename T> class tCurveBVH
+{
+public:
+	typedef tFunction<N, T> Function;
+
+
+	tCurveBVH(const Function& function) :
+
+		m_Function(function),
+		m_NbIntervals(function.nb_entries - 1)
+
+	{
+		const float* table = function.arc_lengths;
+
+		// Positions at each table entry, kept for the initial guesses, along with the
+		// second differentials used for the bounds
+		m_Points = new float[function.nb_entries * N];
+		float* d2 = new float[function.nb_entries * N];
+
+		int i, j;
+		for (i = 0; i < function.nb_entries; i++)
+		{
+			CurveSample<N> sample = function.Evaluate(table[i * 2], 2);
+			for (j = 0; j < N; j++)
+			{
+				m_Points[i * N + j] = sample.position.values[j];
+				d2[i * N + j] = (float)fabs(sample.d2.values[j]);
+			}
+		}
+
+		// A balanced binary tree has one less branch than it has leaves
+		m_Nodes = new Node[m_NbIntervals * 2 - 1];
+		m_NbNodes = 0;
+		Build(0, m_NbIntervals, d2);
+
+		delete [] d2;
+	}
+
+
+	~tCurveBVH(void)
+	{
+		delete [] m_Nodes;
+		delete [] m_Points;
+	}
+
+
+	CurveProjection GetClosestPoint(const Point<N>& point) const
+	{
+		Closest closest;
+		closest.distance_sq = -1;
+		closest.interval = 0;
+		closest.u = 0;
+
+		// Depth first, visiting the nearer child first so that the best distance shrinks
+		// quickly and prunes most of the rest. The tree is balanced so the stack never
+		// gets deeper than the log of the number of intervals.
+		int stack[64];
+		int nb_stacked = 0;
+		stack[nb_stacked++] = 0;
+
+		while (nb_stacked)
+		{
+			const Node& node = m_Nodes[stack[--nb_stacked]];
+			if (closest.distance_sq >= 0 && node.DistanceSq(point) >= closest.distance_sq)
+				continue;
+
+			if (node.last - node.first == 1)
+			{
+				RefineInterval(node.first, point, closest);
+				continue;
+			}
+
+			// Push the farther child first so the nearer is popped next
+			int left = &node - m_Nodes + 1;
+			int right = node.right;
+			float left_distance = m_Nodes[left].DistanceSq(point);
+			float right_distance = m_Nodes[right].DistanceSq(point);
+			if (left_distance < right_distance)
+			{
+				stack[nb_stacked++] = right;
+				stack[nb_stacked++] = left;
+			}
+			else
+			{
+				stack[nb_stacked++] = left;
+				stack[nb_stacked++] = right;
+			}
+		}
+
+		// Arc-length from the start of the interval the point was found in
+		const float* entry = m_Function.arc_lengths + closest.interval * 2;
+
+		CurveProjection projection;
+		projection.u = closest.u;
+		projection.s = entry[1] + m_Function.GaussianQuadrature(entry[0], closest.u);
+		projection.distance = (float)sqrt(closest.distance_sq);
+		return (projection);
+	}
+
+
+	int GetNbNodes(void) const
+	{
+		return (m_NbNodes);
+	}
+
+
+private:
+	// Steps taken across an interval by SearchInterval(), each of which can hold a minimum
+	enum { NB_SEARCH_STEPS = 8 };
+
+
+	struct Node
+	{
+		// Squared distance from a point to the box, zero inside it
+		float DistanceSq(const Point<N>& p) const
+		{
+			float d = 0;
+
+			for (int i = 0; i < N; i++)
+			{
+				float v = p.values[i];
+				if (v < min[i])
+					d += (min[i] - v) * (min[i] - v);
+				else if (v > max[i])
+					d += (v - max[i]) * (v - max[i]);
+			}
+
+			return (d);
+		}
+
+
+		// Bounds of all the curve within
+		float	min[N];
+		float	max[N];
+
+		// Range of table intervals within
+		int		first;
+		int		last;
+
+		// The left child always comes straight after its parent
+		int		right;
+	};
+
+
+	struct Closest
+	{
+		float	distance_sq;
+		int		interval;
+		float	u;
+	};
+
+
+	// Creates the node for the range of intervals, and all those below it, returning its
+	// index. Splitting the range in the middle keeps the tree balanced, and as intervals next
+	// to each other in the table are next to each other in space, the boxes stay tight.
+	int Build(const int first, const int last, const float* d2)
+	{
+		int index = m_NbNodes++;
+		Node& node = m_Nodes[index];
+		node.first = first;
+		node.last = last;
+
+		int j;
+		if (last - first == 1)
+		{
+			const float* table = m_Function.arc_lengths + first * 2;
+			float du = table[2] - table[0];
+
+			// Second differential in the middle of the interval
+			CurveSample<N> sample = m_Function.Evaluate((table[0] + table[2]) / 2, 2);
+
+			const float* p0 = m_Points + first * N;
+			const float* p1 = p0 + N;
+			for (j = 0; j < N; j++)
+			{
+				float m = d2[first * N + j];
+				if (d2[(first + 1) * N + j] > m)
+					m = d2[(first + 1) * N + j];
+				if ((float)fabs(sample.d2.values[j]) > m)
+					m = (float)fabs(sample.d2.values[j]);
+
+				float bow = m * du * du / 8;
+				node.min[j] = (p0[j] < p1[j] ? p0[j] : p1[j]) - bow;
+				node.max[j] = (p0[j] > p1[j] ? p0[j] : p1[j]) + bow;
+			}
+
+			node.right = -1;
+			return (index);
+		}
+
+		int mid_point = (first + last) >> 1;
+		const Node& left = m_Nodes[Build(first, mid_point, d2)];
+		node.right = Build(mid_point, last, d2);
+		const Node& right = m_Nodes[node.right];
+
+		for (j = 0; j < N; j++)
+		{
+			node.min[j] = left.min[j] < right.min[j] ? left.min[j] : right.min[j];
+			node.max[j] = left.max[j] > right.max[j] ? left.max[j] : right.max[j];
+		}
+
+		return (index);
+	}
+
+
+	// Finds the closest point within one interval, keeping it if it beats the best so far
+	void RefineInterval(const int i, const Point<N>& point, Closest& closest) const
+	{
+		const float* table = m_Function.arc_lengths + i * 2;
+		float u0 = table[0];
+		float u1 = table[2];
+
+		// Initial guess projects onto the line between the end points
+		const float* p0 = m_Points + i * N;
+		const float* p1 = p0 + N;
+		float along = 0, chord_sq = 0;
+		int j;
+		for (j = 0; j < N; j++)
+		{
+			float chord = p1[j] - p0[j];
+			along += (point.values[j] - p0[j]) * chord;
+			chord_sq += chord * chord;
+		}
+
+		float t = chord_sq > 0 ? along / chord_sq : 0;
+		if (t < 0) t = 0;
+		if (t > 1) t = 1;
+		float u = u0 + t * (u1 - u0);
+
+		// Newton-Raphson on the squared distance, whose first and second differentials
+		// halved are (P - point).P' and P'.P' + (P - point).P''. It's only trusted if the
+		// distance stays convex and it settles inside the interval.
+		bool converged = false;
+		for (int k = 0; k < 4; k++)
+		{
+			CurveSample<N> sample = m_Function.Evaluate(u, 2);
+			Point<N> offset = sample.position - point;
+
+			float g1 = offset.Dot(sample.d1);
+			float g2 = sample.d1.Dot(sample.d1) + offset.Dot(sample.d2);
+			if (g2 <= 0)
+				break;
+
+			float step = g1 / g2;
+			u -= step;
+			if (u < u0 || u > u1)
+				break;
+
+			if (fabs(step) < 1e-6f * (u1 - u0))
+			{
+				converged = true;
+				break;
+			}
+		}
+
+		if (converged)
+		{
+			Point<N> offset = m_Function.Position(u) - point;
+			Consider(i, u, offset.Dot(offset), closest);
+		}
+		else
+		{
+			SearchInterval(i, point, closest);
+		}
+
+		// The closest point may be at either end, where the distance needn't level off
+		float d0 = 0, d1 = 0;
+		for (j = 0; j < N; j++)
+		{
+			d0 += (point.values[j] - p0[j]) * (point.values[j] - p0[j]);
+			d1 += (point.values[j] - p1[j]) * (point.values[j] - p1[j]);
+		}
+
+		Consider(i, u0, d0, closest);
+		Consider(i, u1, d1, closest);
+	}
+
+
+	// The slow but sure way of finding the closest point within an interval, for when
+	// Newton-Raphson can't be trusted. The interval is crossed in a few steps looking for
+	// where the distance stops falling and starts rising, and each minimum found is homed in
+	// on by keeping it bracketed: Newton-Raphson steps are taken where they land inside the
+	// bracket, and it's halved where they don't.
+	void SearchInterval(const int i, const Point<N>& point, Closest& closest) const
+	{
+		const float* table = m_Function.arc_lengths + i * 2;
+		float u0 = table[0];
+		float u1 = table[2];
+		float tolerance = 1e-6f * (u1 - u0);
+
+		float prev_u = u0;
+		float prev_g1 = GetDistanceSlope(u0, point);
+
+		for (int k = 1; k <= NB_SEARCH_STEPS; k++)
+		{
+			float next_u = u0 + (u1 - u0) * (float)k / (float)NB_SEARCH_STEPS;
+			float next_g1 = GetDistanceSlope(next_u, point);
+
+			if (prev_g1 < 0 && next_g1 >= 0)
+			{
+				float a = prev_u, b = next_u;
+				float u = (a + b) / 2;
+
+				for (int j = 0; j < 32; j++)
+				{
+					CurveSample<N> sample = m_Function.Evaluate(u, 2);
+					Point<N> offset = sample.position - point;
+
+					float g1 = offset.Dot(sample.d1);
+					float g2 = sample.d1.Dot(sample.d1) + offset.Dot(sample.d2);
+					if (g1 < 0)
+						a = u;
+					else
+						b = u;
+
+					float next = g2 > 0 ? u - g1 / g2 : u;
+					if (!(next > a && next < b))
+						next = (a + b) / 2;
+
+					bool done = fabs(next - u) < tolerance;
+					u = next;
+					if (done)
+						break;
+				}
+
+				Point<N> offset = m_Function.Position(u) - point;
+				Consider(i, u, offset.Dot(offset), closest);
+			}
+
+			prev_u = next_u;
+			prev_g1 = next_g1;
+		}
+	}
+
+
+	// Half the rate of change of the squared distance to the point, (P - point).P'
+	float GetDistanceSlope(const float u, const Point<N>& point) const
+	{
+		CurveSample<N> sample = m_Function.Evaluate(u, 1);
+		return ((sample.position - point).Dot(sample.d1));
+	}
+
+
+	static void Consider(const int i, const float u, const float distance_sq, Closest& closest)
+	{
+		if (closest.distance_sq < 0 || distance_sq < closest.distance_sq)
+		{
+			closest.distance_sq = distance_sq;
+			closest.interval = i;
+			closest.u = u;
+		}
+	}
+
+
+	const Function&	m_Function;
+
+	int		m_NbIntervals;
+
+	// Position at each table entry
+	float*	m_Points;
+
+	Node*	m_Nodes;
+	int		m_NbNodes;
+};
+
+
+#endif	/* _INCLUDED_CURVEBVH_H */
@@ -0,0 +1,129 @@
+
+#ifndef	_INCLUDED_CURVEEVALUATION_H
+#define	_INCLUDED_CURVEEVALUATION_H
+
+
+#ifndef	_INCLUDED_POINT_H
+	#include "Point.h"
+#endif
+
+
+// Evaluation of all the dimensions of a curve at once, given the array of per-dimension
+// component types that tFunction holds. These generic versions go one dimension at a time
+// and work with any component type providing P() and D1(). A component type can overload
+// them for arrays of itself to evaluate every dimension together, as CubicPolynomial does
+// with SSE.
+
+
+// Position and differentials of a curve at one point, only as many differentials as were
+// asked for are filled in
+template <int N> struct CurveSample
+{
+	// Direction of travel with unit length, needs the first differential
+	Point<N> GetTangent(void) const
+	{
+		float length = d1.Length();
+		return (length > 0 ? d1 * (1 / length) : d1);
+	}
+
+
+	// One over the radius of the circle that best fits the curve at this point, needs both
+	// differentials. This is |d1 x d2| / |d1|^3, written with dot products so that it works
+	// in any number of dimensions.
+	float GetCurvature(void) const
+	{
+		float d1d1 = d1.Dot(d1);
+		if (d1d1 == 0)
+			return (0);
+
+		float d1d2 = d1.Dot(d2);
+		float cross = d1d1 * d2.Dot(d2) - d1d2 * d1d2;
+		return ((float)sqrt(cross > 0 ? cross : 0) / (d1d1 * (float)sqrt(d1d1)));
+	}
+
+
+	// Number of differentials filled in, up to 2
+	int		order;
+
+	Point<N>	position;
+	Point<N>	d1;
+	Point<N>	d2;
+};
+
+
+// Position of one dimension in values[0], followed by the differentials up to the given
+// order. Component types that can share work between them should overload this.
+template <typename T> inline void EvaluateComponent(const T& c, const float u, const int order, float* values)
+{
+	values[0] = c.P(u);
+	if (order > 0)
+		values[1] = c.D1(u);
+	if (order > 1)
+		values[2] = c.D2(u);
+}
+
+
+template <int N, typename T> inline void EvaluatePosition(const T (&curve)[N], const float u, Point<N>& p)
+{
+	for (int i = 0; i < N; i++)
+		p.values[i] = curve[i].P(u);
+}
+
+
+// Returns modulus[dP/du], the arc-length integrand
+template <int N, typename T> inline float EvaluateSpeed(const T (&curve)[N], const float u)
+{
+	float val = 0;
+
+	// Sum the squared first differentials for each dimension at the given point
+	for (int i = 0; i < N; i++)
+	{
+		float d = curve[i].D1(u);
+		val += d * d;
+	}
+
+	return ((float)sqrt(val));
+}
+
+
+// Speeds at a whole array of parameters, for integration rules that sample at many points
+template <int N, typename T> inline void EvaluateSpeeds(const T (&curve)[N], const float* u, float* speeds, const int count)
+{
+	for (int i = 0; i < count; i++)
+		speeds[i] = EvaluateSpeed(curve, u[i]);
+}
+
+
+// Position and first differential together, returning the speed
+template <int N, typename T> inline float EvaluateFused(const T (&curve)[N], const float u, Point<N>& p, Point<N>& d1)
+{
+	for (int i = 0; i < N; i++)
+	{
+		p.values[i] = curve[i].P(u);
+		d1.values[i] = curve[i].D1(u);
+	}
+
+	return (d1.Length());
+}
+
+
+// Position and differentials up to the given order for all dimensions
+template <int N, typename T> inline void EvaluateCurve(const T (&curve)[N], const float u, const int order, CurveSample<N>& sample)
+{
+	sample.order = order;
+
+	for (int i = 0; i < N; i++)
+	{
+		float values[3];
+		EvaluateComponent(curve[i], u, order, values);
+
+		sample.position.values[i] = values[0];
+		if (order > 0)
+			sample.d1.values[i] = values[1];
+		if (order > 1)
+			sample.d2.values[i] = values[2];
+	}
+}
+
+
+#endif	/* _INCLUDED_CURVEEVALUATION_H */
@@ -0,0 +1,258 @@
+
+#ifndef	_INCLUDED_CURVEPACK_H
+#define	_INCLUDED_CURVEPACK_H
+
+
+#ifndef	_INCLUDED_CUBICPOLYNOMIAL_H
+	#include "CubicPolynomial.h"
+#endif
+
+#ifndef	_INCLUDED_FUNCTION_H
+	#include "Function.h"
+#endif
+
+
+// Answers one arc-length to parameter query for each of a whole set of cubic curves at
+// once, for when there are lots of followers each on a curve of their own. The curves are
+// packed in blocks of four with every coefficient of the four held side by side, so that
+// with ARCLENGTH_SSE each lane of a register works on a different curve: the table search
+// runs for all four together until the last has found its interval, then the initial guess
+// and the Newton-Raphson steps, quadrature included, are done for all four at once.
+//
+// The coefficients are copied and the tables referenced when the pack is created, so it
+// has to be created again if any of the curves or their tables change.
+template <int N> class tCurvePack
+{
+public:
+	typedef tFunction<N, CubicPolynomial> Function;
+
+
+	tCurvePack(const Function* const* functions, const int nb_functions) :
+
+		m_NbFunctions(nb_functions),
+		m_NbBlocks((nb_functions + WIDTH - 1) / WIDTH)
+
+	{
+		m_Functions = new const Function*[nb_functions];
+		for (int i = 0; i < nb_functions; i++)
+			m_Functions[i] = functions[i];
+
+		m_Blocks = new Block[m_NbBlocks];
+		for (int i = 0; i < m_NbBlocks * WIDTH; i++)
+		{
+			// Spare lanes at the end repeat the last curve so they have something sensible
+			// to work on, their results are thrown away
+			const Function* f = functions[i < nb_functions ? i : nb_functions - 1];
+			Block& block = m_Blocks[i / WIDTH];
+			int lane = i % WIDTH;
+
+			// Only the first differential is needed
+			for (int j = 0; j < N; j++)
+			{
+				block.a[j][lane] = 3 * f->curve[j].a;
+				block.b[j][lane] = 2 * f->curve[j].b;
+				block.c[j][lane] = f->curve[j].c;
+			}
+
+			block.tables[lane] = f->arc_lengths;
+			block.nb_entries[lane] = f->nb_entries;
+		}
+	}
+
+
+	~tCurvePack(void)
+	{
+		delete [] m_Blocks;
+		delete [] m_Functions;
+	}
+
+
+	// Find the parameter u[i] at arc-length s[i] along curve i, for every curve in the pack.
+	// Gives the same results as calling GetParameterNewtonRaphson() on each.
+	void GetParameters(const float* s, float* u) const
+	{
+#ifdef	ARCLENGTH_SSE
+
+		for (int i = 0; i < m_NbBlocks; i++)
+		{
+			int first = i * WIDTH;
+			int count = m_NbFunctions - first < WIDTH ? m_NbFunctions - first : WIDTH;
+
+			// Copy the block's queries out so the spare lanes can be filled in
+			float block_s[WIDTH], block_u[WIDTH];
+			for (int j = 0; j < WIDTH; j++)
+				block_s[j] = s[first + (j < count ? j : count - 1)];
+
+			SolveBlock(m_Blocks[i], block_s, block_u);
+
+			for (int j = 0; j < count; j++)
+				u[first + j] = block_u[j];
+		}
+
+#else
+
+		for (int i = 0; i < m_NbFunctions; i++)
+			u[i] = m_Functions[i]->GetParameterNewtonRaphson(s[i]);
+
+#endif
+	}
+
+
+	int GetNbFunctions(void) const
+	{
+		return (m_NbFunctions);
+	}
+
+
+private:
+	enum
+	{
+		// Curves in each block, one per SSE lane
+		WIDTH = 4
+	};
+
+
+	struct Block
+	{
+		// Coefficients of the first differential for each dimension, one curve per lane
+		float	a[N][WIDTH];
+		float	b[N][WIDTH];
+		float	c[N][WIDTH];
+
+		// Arc-length table for each lane
+		const float*	tables[WIDTH];
+		int				nb_entries[WIDTH];
+	};
+
+
+#ifdef	ARCLENGTH_SSE
+
+	struct Lanes
+	{
+		__m128	a[N], b[N], c[N];
+
+
+		// modulus[dP/du] for each curve at its own parameter
+		__m128 Speed(const __m128 u) const
+		{
+			__m128 sum = _mm_setzero_ps();
+
+			for (int j = 0; j < N; j++)
+			{
+				__m128 v = _mm_add_ps(_mm_mul_ps(a[j], u), b[j]);
+				v = _mm_add_ps(_mm_mul_ps(v, u), c[j]);
+				sum = _mm_add_ps(sum, _mm_mul_ps(v, v));
+			}
+
+			return (_mm_sqrt_ps(sum));
+		}
+
+
+		// Same rule as tFunction::GaussianQuadrature() with a different range per curve
+		__m128 GaussianQuadrature(const __m128 u0, const __m128 u1) const
+		{
+			__m128 mid_point = _mm_mul_ps(_mm_set1_ps(0.5f), _mm_add_ps(u0, u1));
+			__m128 range = _mm_sub_ps(mid_point, u0);
+
+			__m128 s = _mm_setzero_ps();
+			for (int i = 0; i < 5; i++)
+			{
+				__m128 dx = _mm_mul_ps(range, _mm_set1_ps(g_GaussAbscissas[i]));
+				__m128 f = _mm_add_ps(Speed(_mm_add_ps(mid_point, dx)), Speed(_mm_sub_ps(mid_point, dx)));
+				s = _mm_add_ps(s, _mm_mul_ps(_mm_set1_ps(g_GaussWeights[i]), f));
+			}
+
+			return (_mm_mul_ps(s, range));
+		}
+	};
+
+
+	void SolveBlock(const Block& block, const float* s, float* u) const
+	{
+		// Binary search each lane's table until they've all narrowed down to one interval.
+		// There's no way to gather from four different tables in SSE so this part is done
+		// a lane at a time, skipping the ones that have finished.
+		int min_i[WIDTH], max_i[WIDTH];
+		int lane;
+		for (lane = 0; lane < WIDTH; lane++)
+		{
+			min_i[lane] = 0;
+			max_i[lane] = block.nb_entries[lane] - 1;
+		}
+
+		bool is_searching = true;
+		while (is_searching)
+		{
+			is_searching = false;
+			for (lane = 0; lane < WIDTH; lane++)
+			{
+				if (max_i[lane] - min_i[lane] > 1)
+				{
+					int mid_point = (min_i[lane] + max_i[lane]) >> 1;
+					if (s[lane] >= block.tables[lane][mid_point * 2 + 1])
+						min_i[lane] = mid_point;
+					else
+						max_i[lane] = mid_point;
+
+					is_searching = true;
+				}
+			}
+		}
+
+		// Gather the parameters and arc-lengths either side of each query
+		float v0[WIDTH], v1[WIDTH], l0[WIDTH], l1[WIDTH];
+		for (lane = 0; lane < WIDTH; lane++)
+		{
+			const float* entry = block.tables[lane] + min_i[lane] * 2;
+			v0[lane] = entry[0];
+			l0[lane] = entry[1];
+			v1[lane] = entry[2];
+			l1[lane] = entry[3];
+		}
+
+		Lanes lanes;
+		for (int j = 0; j < N; j++)
+		{
+			lanes.a[j] = _mm_loadu_ps(block.a[j]);
+			lanes.b[j] = _mm_loadu_ps(block.b[j]);
+			lanes.c[j] = _mm_loadu_ps(block.c[j]);
+		}
+
+		__m128 zero = _mm_setzero_ps();
+		__m128 vs = _mm_loadu_ps(s);
+		__m128 vv0 = _mm_loadu_ps(v0);
+		__m128 vl0 = _mm_loadu_ps(l0);
+
+		// Initial guess is a lerp between the parameters, masked to the start of the
+		// interval in lanes where it has no length
+		__m128 dl = _mm_sub_ps(_mm_loadu_ps(l1), vl0);
+		__m128 t = _mm_and_ps(_mm_cmpneq_ps(dl, zero), _mm_div_ps(_mm_sub_ps(vs, vl0), dl));
+		__m128 p = _mm_add_ps(vv0, _mm_mul_ps(t, _mm_sub_ps(_mm_loadu_ps(v1), vv0)));
+
+		// Same two Newton-Raphson iterations as the single curve version, leaving any lane
+		// where the curve has stopped dead where it is
+		for (int i = 0; i < 2; i++)
+		{
+			__m128 f = _mm_sub_ps(_mm_sub_ps(vs, vl0), lanes.GaussianQuadrature(vv0, p));
+			__m128 fd = lanes.Speed(p);
+			__m128 step = _mm_and_ps(_mm_cmpneq_ps(fd, zero), _mm_div_ps(f, fd));
+			p = _mm_add_ps(p, step);
+		}
+
+		_mm_storeu_ps(u, p);
+	}
+
+#endif
+
+
+	int		m_NbFunctions;
+	int		m_NbBlocks;
+
+	// The curves themselves for when there's no SSE
+	const Function**	m_Functions;
+
+	Block*	m_Blocks;
+};
+
+
+#endif	/* _INCLUDED_CURVEPACK_H */
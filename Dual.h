@@ -0,0 +1,201 @@
+
+#ifndef	_INCLUDED_DUAL_H
+#define	_INCLUDED_DUAL_H
+
+
+#include <math.h>
+
+
+// Dual numbers for forward-mode automatic differentiation. A dual carries a value along
+// with its derivative with respect to some variable, and every operation on it applies the
+// chain rule as it goes, so evaluating a function on (u, 1) gives back the function and its
+// exact derivative at u. Nesting one dual inside another does the same again for the second
+// derivative.
+template <typename S> struct tDual
+{
+	tDual(void) : value(0), deriv(0)
+	{
+	}
+
+
+	tDual(const S& v, const S& d) : value(v), deriv(d)
+	{
+	}
+
+
+	// Constants have no derivative. Templated so that a plain float converts straight into
+	// a nested dual.
+	template <typename U> tDual(const U& v) : value(v), deriv(0)
+	{
+	}
+
+
+	friend tDual operator + (const tDual& a, const tDual& b)
+	{
+		return (tDual(a.value + b.value, a.deriv + b.deriv));
+	}
+
+
+	friend tDual operator - (const tDual& a, const tDual& b)
+	{
+		return (tDual(a.value - b.value, a.deriv - b.deriv));
+	}
+
+
+	friend tDual operator * (const tDual& a, const tDual& b)
+	{
+		return (tDual(a.value * b.value, a.deriv * b.value + a.value * b.deriv));
+	}
+
+
+	friend tDual operator / (const tDual& a, const tDual& b)
+	{
+		return (tDual(a.value / b.value, (a.deriv * b.value - a.value * b.deriv) / (b.value * b.value)));
+	}
+
+
+	tDual operator - (void) const
+	{
+		return (tDual(-value, -deriv));
+	}
+
+
+	tDual& operator += (const tDual& b)
+	{
+		return (*this = *this + b);
+	}
+
+
+	tDual& operator -= (const tDual& b)
+	{
+		return (*this = *this - b);
+	}
+
+
+	tDual& operator *= (const tDual& b)
+	{
+		return (*this = *this * b);
+	}
+
+
+	S	value;
+	S	deriv;
+};
+
+
+// The usual maths functions, with their derivatives
+template <typename S> inline tDual<S> sin(const tDual<S>& x)
+{
+	return (tDual<S>(sin(x.value), x.deriv * cos(x.value)));
+}
+
+
+template <typename S> inline tDual<S> cos(const tDual<S>& x)
+{
+	return (tDual<S>(cos(x.value), -x.deriv * sin(x.value)));
+}
+
+
+template <typename S> inline tDual<S> exp(const tDual<S>& x)
+{
+	S e = exp(x.value);
+	return (tDual<S>(e, x.deriv * e));
+}
+
+
+template <typename S> inline tDual<S> log(const tDual<S>& x)
+{
+	return (tDual<S>(log(x.value), x.deriv / x.value));
+}
+
+
+template <typename S> inline tDual<S> sqrt(const tDual<S>& x)
+{
+	S r = sqrt(x.value);
+	return (tDual<S>(r, x.deriv / (r * 2)));
+}
+
+
+template <typename S> inline tDual<S> pow(const tDual<S>& x, const float n)
+{
+	return (tDual<S>(pow(x.value, n), x.deriv * n * pow(x.value, n - 1)));
+}
+
+
+// Turns a component type that only knows how to evaluate itself into one that tFunction
+// can use, generating D1() and D2() from its P(). T needs P() templated on the number type,
+// written with ordinary arithmetic and the functions above:
+//
+//		struct Wave
+//		{
+//			float amplitude, frequency;
+//
+//			template <typename S> S P(const S& u) const
+//			{
+//				return (amplitude * sin(u * frequency));
+//			}
+//		};
+//
+//		tFunction<2, tAutoDiff<Wave> > f(1);
+//
+template <typename T> struct tAutoDiff : public T
+{
+	float P(const float u) const
+	{
+		return (T::P(u));
+	}
+
+
+	float D1(const float u) const
+	{
+		float p, d1;
+		Derivatives(u, p, d1);
+		return (d1);
+	}
+
+
+	float D2(const float u) const
+	{
+		float p, d1, d2;
+		Derivatives(u, p, d1, d2);
+		return (d2);
+	}
+
+
+	// Position and the first differential from a single evaluation
+	void Derivatives(const float u, float& p, float& d1) const
+	{
+		tDual<float> r = T::P(tDual<float>(u, 1));
+
+		p = r.value;
+		d1 = r.deriv;
+	}
+
+
+	// Position and both differentials from a single evaluation
+	void Derivatives(const float u, float& p, float& d1, float& d2) const
+	{
+		// Differentiate the first differential again by nesting one dual inside another
+		tDual< tDual<float> > x(tDual<float>(u, 1), tDual<float>(1, 0));
+		tDual< tDual<float> > r = T::P(x);
+
+		p = r.value.value;
+		d1 = r.value.deriv;
+		d2 = r.deriv.deriv;
+	}
+};
+
+
+// Only evaluates as many times as the highest differential needs
+template <typename T> inline void EvaluateComponent(const tAutoDiff<T>& c, const float u, const int order, float* values)
+{
+	if (order > 1)
+		c.Derivatives(u, values[0], values[1], values[2]);
+	else if (order > 0)
+		c.Derivatives(u, values[0], values[1]);
+	else
+		values[0] = c.P(u);
+}
+
+
+#endif	/* _INCLUDED_DUAL_H */
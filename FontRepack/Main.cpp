@@ -0,0 +1,475 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "../SDLApp/SDLAFontFormat.h"
+
+
+// Largest atlas that will be tried before spilling onto more pages
+static const int MAX_ATLAS_SIZE = 1024;
+
+// Empty texels left around each glyph so that neighbours never bleed into each other
+static const int GLYPH_PADDING = 1;
+
+
+struct Glyph
+{
+	// Character description as it will be written out
+	FontDBChar	desc;
+
+	// Cropped coverage, w * h bytes
+	unsigned char*	coverage;
+};
+
+
+struct Font
+{
+	Font(void) : nb_glyphs(0), glyphs(0) { }
+
+	~Font(void)
+	{
+		for (int i = 0; i < nb_glyphs; i++)
+			delete [] glyphs[i].coverage;
+		delete [] glyphs;
+	}
+
+	int		nb_glyphs;
+	Glyph*	glyphs;
+};
+
+
+// Sorted list of horizontal segments describing the top of everything packed so far
+class cSkyline
+{
+public:
+	cSkyline(const int width, const int height) :
+
+		m_Width(width),
+		m_Height(height),
+		m_NbNodes(1)
+
+	{
+		// Can never need more nodes than there are columns
+		m_Nodes = new Node[width + 1];
+		m_Nodes[0].x = 0;
+		m_Nodes[0].y = 0;
+		m_Nodes[0].w = width;
+	}
+
+
+	~cSkyline(void)
+	{
+		delete [] m_Nodes;
+	}
+
+
+	// Find the lowest position a w * h rectangle fits, preferring the left. Returns false
+	// if it doesn't fit anywhere.
+	bool Insert(const int w, const int h, int& out_x, int& out_y)
+	{
+		int best_i = -1, best_y = m_Height, best_x = 0;
+
+		for (int i = 0; i < m_NbNodes; i++)
+		{
+			// Rest at the highest node underneath the whole width of the rectangle
+			int x = m_Nodes[i].x;
+			if (x + w > m_Width)
+				break;
+
+			int y = 0, width_left = w;
+			for (int j = i; width_left > 0; j++)
+			{
+				if (m_Nodes[j].y > y)
+					y = m_Nodes[j].y;
+				width_left -= m_Nodes[j].w;
+			}
+
+			if (y + h <= m_Height && y < best_y)
+			{
+				best_i = i;
+				best_x = x;
+				best_y = y;
+			}
+		}
+
+		if (best_i == -1)
+			return (false);
+
+		AddNode(best_i, best_x, best_y + h, w);
+
+		out_x = best_x;
+		out_y = best_y;
+		return (true);
+	}
+
+
+private:
+	struct Node
+	{
+		int		x, y, w;
+	};
+
+
+	void AddNode(const int index, const int x, const int y, const int w)
+	{
+		int i;
+
+		// Insert the new top
+		memmove(&m_Nodes[index + 1], &m_Nodes[index], (m_NbNodes - index) * sizeof(Node));
+		m_Nodes[index].x = x;
+		m_Nodes[index].y = y;
+		m_Nodes[index].w = w;
+		m_NbNodes++;
+
+		// Shrink or remove the nodes it now covers
+		for (i = index + 1; i < m_NbNodes; i++)
+		{
+			int covered = x + w - m_Nodes[i].x;
+			if (covered <= 0)
+				break;
+
+			if (covered >= m_Nodes[i].w)
+			{
+				memmove(&m_Nodes[i], &m_Nodes[i + 1], (m_NbNodes - i - 1) * sizeof(Node));
+				m_NbNodes--;
+				i--;
+				continue;
+			}
+
+			m_Nodes[i].x += covered;
+			m_Nodes[i].w -= covered;
+			break;
+		}
+
+		// Merge neighbours at the same height
+		for (i = 0; i < m_NbNodes - 1; i++)
+		{
+			if (m_Nodes[i].y == m_Nodes[i + 1].y)
+			{
+				m_Nodes[i].w += m_Nodes[i + 1].w;
+				memmove(&m_Nodes[i + 1], &m_Nodes[i + 2], (m_NbNodes - i - 2) * sizeof(Node));
+				m_NbNodes--;
+				i--;
+			}
+		}
+	}
+
+
+	int		m_Width;
+	int		m_Height;
+
+	int		m_NbNodes;
+	Node*	m_Nodes;
+};
+
+
+void CropGlyph(Glyph& glyph, const unsigned char* page, const int page_width, const int page_height, const int bpp)
+{
+	FontDBChar& d = glyph.desc;
+	int x, y, min_x = d.w, max_x = -1, min_y = d.h, max_y = -1;
+
+	// Find the real bounds of the glyph's coverage
+	for (y = 0; y < d.h; y++)
+	{
+		for (x = 0; x < d.w; x++)
+		{
+			int px = d.x + x, py = d.y + y;
+			if (px < 0 || py < 0 || px >= page_width || py >= page_height)
+				continue;
+
+			// Any channel being lit counts
+			const unsigned char* texel = &page[(py * page_width + px) * bpp];
+			int total = 0;
+			for (int c = 0; c < bpp; c++)
+				total += texel[c];
+
+			if (total)
+			{
+				if (x < min_x) min_x = x;
+				if (x > max_x) max_x = x;
+				if (y < min_y) min_y = y;
+				if (y > max_y) max_y = y;
+			}
+		}
+	}
+
+	// Empty glyphs still keep their advance
+	if (max_x < 0)
+	{
+		d.w = 0;
+		d.h = 0;
+		glyph.coverage = 0;
+		return;
+	}
+
+	int w = max_x - min_x + 1;
+	int h = max_y - min_y + 1;
+	glyph.coverage = new unsigned char[w * h];
+
+	// Copy out the coverage, taking the brightest channel
+	for (y = 0; y < h; y++)
+	{
+		for (x = 0; x < w; x++)
+		{
+			const unsigned char* texel = &page[((d.y + min_y + y) * page_width + d.x + min_x + x) * bpp];
+			unsigned char cov = 0;
+			for (int c = 0; c < bpp; c++)
+				cov = texel[c] > cov ? texel[c] : cov;
+
+			glyph.coverage[y * w + x] = cov;
+		}
+	}
+
+	// Keep the glyph in the same place in its character cell
+	d.x_offset += min_x;
+	d.y_offset += min_y;
+	d.w = w;
+	d.h = h;
+}
+
+
+bool ParseFont(const unsigned char* data, const int size, Font& font)
+{
+	int	i;
+
+	if (size >= (int)sizeof(FontDBHeader) && memcmp(data, FONTDB_MAGIC, 4) == 0)
+	{
+		// The same checks as SDLApp makes when it loads the font
+		const FontDBHeader* header = (const FontDBHeader*)data;
+		if (header->version != FONTDB_VERSION || !FontDBCheckV2(data, size))
+			return (false);
+
+		int page_size = header->page_width * header->page_height;
+		const FontDBChar* chars = (const FontDBChar*)(data + header->chars_offset);
+
+		font.nb_glyphs = header->nb_chars;
+		font.glyphs = new Glyph[font.nb_glyphs];
+
+		for (i = 0; i < font.nb_glyphs; i++)
+		{
+			font.glyphs[i].desc = chars[i];
+			CropGlyph(font.glyphs[i], data + header->pages_offset + chars[i].tpage * page_size, header->page_width, header->page_height, 1);
+		}
+	}
+
+	else
+	{
+		int nb_pages, nb_chars;
+		if (!FontDBCheckV1(data, size, nb_pages, nb_chars))
+			return (false);
+
+		const unsigned char* pages = data + sizeof(int);
+		const FontDBCharV1* chars = (const FontDBCharV1*)(pages + nb_pages * FONTDB_V1_PAGE_SIZE + sizeof(int));
+
+		font.nb_glyphs = nb_chars;
+		font.glyphs = new Glyph[font.nb_glyphs];
+
+		// Old characters fill the full height of their cell
+		for (i = 0; i < font.nb_glyphs; i++)
+		{
+			FontDBChar& d = font.glyphs[i].desc;
+			d.code = chars[i].code;
+			d.tpage = 0;
+			d.x = chars[i].x;
+			d.y = chars[i].y;
+			d.w = chars[i].w;
+			d.h = FONTDB_CELL_HEIGHT;
+			d.x_offset = 0;
+			d.y_offset = 0;
+			d.advance = chars[i].w;
+
+			CropGlyph(font.glyphs[i], pages + chars[i].tpage * FONTDB_V1_PAGE_SIZE, 256, 256, 3);
+		}
+	}
+
+	return (true);
+}
+
+
+bool ReadFont(const char* filename, Font& font)
+{
+	FILE* fp = fopen(filename, "rb");
+	if (fp == 0)
+		return (false);
+
+	// Read the whole file
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	if (size <= 0 || size > 0x7fffffff)
+	{
+		fclose(fp);
+		return (false);
+	}
+
+	unsigned char* data = new unsigned char[size];
+	bool read = fread(data, 1, size, fp) == (size_t)size;
+	fclose(fp);
+
+	// Nothing is taken from the file without checking it's all there first
+	bool parsed = read && ParseFont(data, (int)size, font);
+
+	delete [] data;
+	return (parsed);
+}
+
+
+int CompareHeight(const void* a, const void* b)
+{
+	const Glyph* ga = *(const Glyph**)a;
+	const Glyph* gb = *(const Glyph**)b;
+
+	// Tallest first, then widest
+	if (ga->desc.h != gb->desc.h)
+		return (gb->desc.h - ga->desc.h);
+	return (gb->desc.w - ga->desc.w);
+}
+
+
+int Pack(Font& font, Glyph** order, const int width, const int height)
+{
+	int nb_pages = 1;
+	cSkyline* skyline = new cSkyline(width, height);
+
+	for (int i = 0; i < font.nb_glyphs; i++)
+	{
+		FontDBChar& d = order[i]->desc;
+
+		// Nothing to place for empty glyphs
+		if (d.w == 0)
+		{
+			d.tpage = 0;
+			d.x = 0;
+			d.y = 0;
+			continue;
+		}
+
+		int x, y;
+		if (skyline->Insert(d.w + GLYPH_PADDING, d.h + GLYPH_PADDING, x, y) == false)
+		{
+			// Start a fresh page
+			delete skyline;
+			skyline = new cSkyline(width, height);
+			nb_pages++;
+
+			if (skyline->Insert(d.w + GLYPH_PADDING, d.h + GLYPH_PADDING, x, y) == false)
+			{
+				delete skyline;
+				return (0);
+			}
+		}
+
+		d.tpage = nb_pages - 1;
+		d.x = x;
+		d.y = y;
+	}
+
+	delete skyline;
+	return (nb_pages);
+}
+
+
+bool WriteFont(const char* filename, Font& font, Glyph** order)
+{
+	int	i, width = 0, height = 0, nb_pages = 0;
+
+	// Find the smallest power of two atlas that everything fits on, trying wider before taller
+	for (int size = 64; size <= MAX_ATLAS_SIZE && nb_pages != 1; size *= 2)
+	{
+		for (height = size / 2; height <= size; height *= 2)
+		{
+			width = size;
+			nb_pages = Pack(font, order, width, height);
+			if (nb_pages == 1)
+				break;
+		}
+	}
+
+	// Spill onto more of the largest pages
+	if (nb_pages != 1)
+	{
+		width = height = MAX_ATLAS_SIZE;
+		nb_pages = Pack(font, order, width, height);
+		if (nb_pages == 0)
+			return (false);
+	}
+
+	// Fill in the header, with the pages aligned after the character list
+	FontDBHeader header;
+	memcpy(header.magic, FONTDB_MAGIC, 4);
+	header.version = FONTDB_VERSION;
+	header.page_width = width;
+	header.page_height = height;
+	header.nb_pages = nb_pages;
+	header.nb_chars = font.nb_glyphs;
+	header.chars_offset = sizeof(header);
+	header.pages_offset = header.chars_offset + font.nb_glyphs * sizeof(FontDBChar);
+	header.pages_offset = (header.pages_offset + FONTDB_PAGE_ALIGN - 1) & ~(FONTDB_PAGE_ALIGN - 1);
+
+	// Copy each glyph to its packed position
+	int page_size = width * height;
+	unsigned char* pages = new unsigned char[nb_pages * page_size];
+	memset(pages, 0, nb_pages * page_size);
+	for (i = 0; i < font.nb_glyphs; i++)
+	{
+		const Glyph& glyph = font.glyphs[i];
+		const FontDBChar& d = glyph.desc;
+		for (int y = 0; y < d.h; y++)
+			memcpy(&pages[d.tpage * page_size + (d.y + y) * width + d.x], &glyph.coverage[y * d.w], d.w);
+	}
+
+	FILE* fp = fopen(filename, "wb");
+	if (fp == 0)
+	{
+		delete [] pages;
+		return (false);
+	}
+
+	// Header, character list and then the aligned pages
+	fwrite(&header, 1, sizeof(header), fp);
+	for (i = 0; i < font.nb_glyphs; i++)
+		fwrite(&font.glyphs[i].desc, 1, sizeof(FontDBChar), fp);
+	for (i = header.chars_offset + font.nb_glyphs * sizeof(FontDBChar); i < header.pages_offset; i++)
+		fputc(0, fp);
+	fwrite(pages, 1, nb_pages * page_size, fp);
+	fclose(fp);
+
+	printf("%d characters packed onto %d %dx%d page(s)\n", font.nb_glyphs, nb_pages, width, height);
+
+	delete [] pages;
+	return (true);
+}
+
+
+int main(int argc, char* argv[])
+{
+	// Not enough args?
+	if (argc < 3)
+	{
+		printf("FontRepack input.fdb output.fdb\n");
+		return (1);
+	}
+
+	Font font;
+	if (ReadFont(argv[1], font) == false)
+	{
+		printf("Couldn't read %s\n", argv[1]);
+		return (1);
+	}
+
+	// Pack the biggest glyphs first
+	Glyph** order = new Glyph*[font.nb_glyphs];
+	for (int i = 0; i < font.nb_glyphs; i++)
+		order[i] = &font.glyphs[i];
+	qsort(order, font.nb_glyphs, sizeof(Glyph*), CompareHeight);
+
+	bool written = WriteFont(argv[2], font, order);
+	delete [] order;
+
+	if (written == false)
+	{
+		printf("Couldn't write %s\n", argv[2]);
+		return (1);
+	}
+
+	return (0);
+}
@@ -0,0 +1,153 @@
+
+#ifndef	_INCLUDED_FRAMETABLE_H
+#define	_INCLUDED_FRAMETABLE_H
+
+
+#ifndef	_INCLUDED_FUNCTION_H
+	#include "Function.h"
+#endif
+
+#ifndef	_INCLUDED_QUATERNION_H
+	#include "Quaternion.h"
+#endif
+
+
+// Orientation frames along a 3D curve for camera and vehicle rails, one for each entry of
+// the curve's arc-length table. The frames are rotation minimising: each is carried on
+// from the one before by the double reflection method of Wang, Juttler, Zheng and Liu, so
+// they only twist as much as the curve makes them and never flip where the curvature
+// vanishes, unlike Frenet frames. Every table interval is crossed in a few smaller steps to
+// keep that accurate where entries are far apart.
+//
+// A frame's x axis is the tangent, y is the normal that starts out as close as possible to
+// the up vector given, and z completes the right-handed set. Looking one up is a table
+// search and a slerp between the quaternions either side, with no evaluation of the curve.
+//
+// The frames are built from the current table, so they have to be built again whenever the
+// table is. The table is referenced for lookups and has to outlive this.
+template <typename T> class tFrameTable
+{
+public:
+	typedef tFunction<3, T> Function;
+
+
+	tFrameTable(const Function& function, const Point<3>& up, const int steps_per_interval = 4) :
+
+		m_Function(function)
+
+	{
+		const float* table = function.arc_lengths;
+		m_Frames = new Quaternion[function.nb_entries];
+
+		// First normal is the up vector with any part along the tangent taken out, falling
+		// back on whichever axis is least like the tangent when they're parallel
+		CurveSample<3> sample = function.Evaluate(table[0], 1);
+		Point<3> tangent = sample.GetTangent();
+		Point<3> normal = up - tangent * tangent.Dot(up);
+		if (normal.Length() < 1e-4f)
+		{
+			int axis = 0;
+			for (int i = 1; i < 3; i++)
+			{
+				if (fabs(tangent.values[i]) < fabs(tangent.values[axis]))
+					axis = i;
+			}
+
+			Point<3> other;
+			for (int j = 0; j < 3; j++)
+				other.values[j] = j == axis ? 1.0f : 0.0f;
+			normal = other - tangent * tangent.Dot(other);
+		}
+		normal = normal * (1 / normal.Length());
+
+		m_Frames[0] = Quaternion::FromAxes(tangent, normal, Cross(tangent, normal));
+
+		Point<3> position = sample.position;
+		for (int i = 1; i < function.nb_entries; i++)
+		{
+			float u0 = table[i * 2 - 2];
+			float u1 = table[i * 2];
+
+			for (int j = 1; j <= steps_per_interval; j++)
+			{
+				sample = function.Evaluate(u0 + (u1 - u0) * (float)j / (float)steps_per_interval, 1);
+				Point<3> next_tangent = sample.GetTangent();
+
+				// Reflect the frame in the plane bisecting the step, then again in the plane
+				// that lines the reflected tangent up with the new one
+				Point<3> v1 = sample.position - position;
+				float c1 = v1.Dot(v1);
+				if (c1 > 0)
+				{
+					normal = normal - v1 * (2 * v1.Dot(normal) / c1);
+					tangent = tangent - v1 * (2 * v1.Dot(tangent) / c1);
+				}
+
+				Point<3> v2 = next_tangent - tangent;
+				float c2 = v2.Dot(v2);
+				if (c2 > 0)
+					normal = normal - v2 * (2 * v2.Dot(normal) / c2);
+
+				// Keep rounding errors from building up over a long curve
+				tangent = next_tangent;
+				normal = normal - tangent * tangent.Dot(normal);
+				float length = normal.Length();
+				if (length > 0)
+					normal = normal * (1 / length);
+
+				position = sample.position;
+			}
+
+			m_Frames[i] = Quaternion::FromAxes(tangent, normal, Cross(tangent, normal));
+
+			// Consecutive quaternions on the same side of the sphere so they slerp the short
+			// way without having to check
+			if (m_Frames[i].Dot(m_Frames[i - 1]) < 0)
+				m_Frames[i] = -m_Frames[i];
+		}
+	}
+
+
+	~tFrameTable(void)
+	{
+		delete [] m_Frames;
+	}
+
+
+	Quaternion GetFrameAtArcLength(const float s) const
+	{
+		// Search for the arc-lengths either side of the requested one
+		int i = m_Function.BinarySearch(s, 1);
+		float l0 = m_Function.arc_lengths[i * 2 + 1];
+		float l1 = m_Function.arc_lengths[i * 2 + 3];
+
+		float t = l1 > l0 ? (s - l0) / (l1 - l0) : 0;
+		if (t < 0) t = 0;
+		if (t > 1) t = 1;
+
+		return (Slerp(m_Frames[i], m_Frames[i + 1], t));
+	}
+
+
+	// The same as the tangent, normal and binormal axes
+	void GetFrameAtArcLength(const float s, Point<3>& tangent, Point<3>& normal, Point<3>& binormal) const
+	{
+		GetFrameAtArcLength(s).GetAxes(tangent, normal, binormal);
+	}
+
+
+	// Frame at each table entry
+	const Quaternion* GetFrames(void) const
+	{
+		return (m_Frames);
+	}
+
+
+private:
+	const Function&	m_Function;
+
+	Quaternion*		m_Frames;
+};
+
+
+#endif	/* _INCLUDED_FRAMETABLE_H */
@@ -3,14 +3,44 @@
 #define	_INCLUDED_FUNCTION_H
 
 
+#ifndef	_INCLUDED_EXCEPTION_H
+	#include <Exception.h>
+#endif
+
 #ifndef	_INCLUDED_FUNCTIONBASE_H
 	#include "FunctionBase.h"
 #endif
 
+#ifndef	_INCLUDED_CURVEEVALUATION_H
+	#include "CurveEvaluation.h"
+#endif
+
+
+// Ten point Gauss-Legendre rule over [-1, 1]. The abscissas come in pairs either side of
+// the mid-point so only the positive half is stored, each weight going with both of its
+// pair. The ten weights sum to 2.
+static const float g_GaussAbscissas[5] =
+{
+	0.1488743389f,
+	0.4333953941f,
+	0.6794095682f,
+	0.8650633666f,
+	0.9739065285f
+};
 
-template <int N, typename T> struct tFunction : public FunctionBase<N>
+static const float g_GaussWeights[5] =
 {
-	tFunction(const int _nb_entries) : nb_entries(_nb_entries + 1)
+	0.2955242247f,
+	0.2692667193f,
+	0.2190863625f,
+	0.1494513491f,
+	0.0666713443f
+};
+
+
+template <int N, typename T> struct tFunction : public tFunctionDispatch<N, tFunction<N, T> >
+{
+	tFunction(const int _nb_entries) : nb_entries(_nb_entries + 1), position_cache(0), cache_mode(CACHE_NONE)
 	{
 		// Allocate parameter/arc-length pairs
 		arc_lengths = new float[nb_entries * 2];
@@ -23,26 +53,66 @@ template <int N, typename T> struct tFunction : public FunctionBase<N>
 	~tFunction(void)
 	{
 		// Release all memory
+		delete [] position_cache;
 		delete [] arc_lengths;
 	}
 
 
+	// What the position cache holds for each table entry
+	enum
+	{
+		// No cache, GetPositionAtArcLength() finds the parameter and evaluates the curve
+		CACHE_NONE,
+
+		// Positions only, with tangents estimated from the neighbouring entries
+		CACHE_POSITIONS,
+
+		// Positions and the curve's own unit tangents, twice the memory but interpolation
+		// follows the curve much more closely
+		CACHE_TANGENTS
+	};
+
+
 	// Dimension count
 	enum { n = N };
 
 
-	Point<N> P(const float u) const
+	// Also available as P() through FunctionBase, but this can be inlined
+	Point<N> Position(const float u) const
 	{
 		Point<N> p;
 
-		// For each dimension
-		for (int i = 0; i < N; i++)
-			p.values[i] = curve[i].P(u);
+		// All dimensions together
+		EvaluatePosition(curve, u, p);
 
 		return (p);
 	}
 
 
+	// Position and differentials up to the given order, at most 2, in one pass that shares
+	// the work between them
+	CurveSample<N> Evaluate(const float u, const int order) const
+	{
+		CurveSample<N> sample;
+		EvaluateCurve(curve, u, order, sample);
+		return (sample);
+	}
+
+
+	// The same at an arc-length along the curve
+	CurveSample<N> EvaluateAtArcLength(const float s, const int order) const
+	{
+		return (Evaluate(GetParameter(s), order));
+	}
+
+
+	// Position and first differential in one go, returning the speed modulus[dP/du]
+	float EvalFused(const float u, Point<N>& p, Point<N>& d1) const
+	{
+		return (EvaluateFused(curve, u, p, d1));
+	}
+
+
 	void InitTable(void)
 	{
 		// The first two entries are zero
@@ -53,13 +123,15 @@ template <int N, typename T> struct tFunction : public FunctionBase<N>
 		for (float u = entry_distance; i < nb_entries * 2; u += entry_distance, i += 2)
 		{
 			// Sample previous point and this point along curve
-			Point<N> p0 = P(u - entry_distance);
-			Point<N> p1 = P(u);
+			Point<N> p0 = Position(u - entry_distance);
+			Point<N> p1 = Position(u);
 
 			// Fill in the table entries
 			arc_lengths[i + 0] = u;
 			arc_lengths[i + 1] = arc_lengths[i - 1] + p0.DistanceFrom(p1);
 		}
+
+		UpdatePositionCache();
 	}
 
 
@@ -98,6 +170,20 @@ template <int N, typename T> struct tFunction : public FunctionBase<N>
 			add->next = cur;
 			last->next = add;
 		}
+
+
+		static Pair* Append(Pair* last, const float u, const float s)
+		{
+			// Create the new pair at the end of the list, no searching needed when pairs
+			// are generated in order
+			Pair* add = new Pair;
+			add->u = u;
+			add->s = s;
+			add->next = 0;
+			last->next = add;
+
+			return (add);
+		}
 	};
 
 
@@ -117,9 +203,9 @@ template <int N, typename T> struct tFunction : public FunctionBase<N>
 
 				// Sample the all three points along the segment
 				Point<N> p[3];
-				p[0] = f_ptr->P(u[0]);
-				p[1] = f_ptr->P(u[1]);
-				p[2] = f_ptr->P(u[2]);
+				p[0] = f_ptr->Position(u[0]);
+				p[1] = f_ptr->Position(u[1]);
+				p[2] = f_ptr->Position(u[2]);
 
 				// Estimate the lengths of the two halves and the entire segment
 				float l[3] =
@@ -161,7 +247,8 @@ template <int N, typename T> struct tFunction : public FunctionBase<N>
 		for (cur = pairs; cur; cur = cur->next)
 			nb_entries++;
 
-		// Allocate the table
+		// Allocate the table, replacing any previous one
+		delete [] arc_lengths;
 		arc_lengths = new float[2 * nb_entries];
 
 		// Fill in the start entry
@@ -176,6 +263,16 @@ template <int N, typename T> struct tFunction : public FunctionBase<N>
 			arc_lengths[nb_entries * 2 + 1] = cur->s + arc_lengths[nb_entries * 2 - 1];
 			nb_entries++;
 		}
+
+		// Release the pair list
+		while (pairs)
+		{
+			cur = pairs->next;
+			delete pairs;
+			pairs = cur;
+		}
+
+		UpdatePositionCache();
 	}
 
 
@@ -289,17 +386,15 @@ template <int N, typename T> struct tFunction : public FunctionBase<N>
 	// This samples the arc-length integral function: modulus[dP/du]
 	float EvalIntFunc(const float u) const
 	{
-		float val = 0;
+		// Modulus of the first differentials of all dimensions at the given point
+		return (EvaluateSpeed(curve, u));
+	}
 
-		// Sum the squared first differentials for each dimension at the given point
-		for (int i = 0; i < N; i++)
-		{
-			float d = curve[i].D1(u);
-			val += d * d;
-		}
 
-		// This calculates the modulus to complete the function evaluation
-		return ((float)sqrt(val));
+	// The same for a whole array of parameters at once
+	void EvalIntFuncs(const float* u, float* speeds, const int count) const
+	{
+		EvaluateSpeeds(curve, u, speeds, count);
 	}
 
 
@@ -307,7 +402,7 @@ template <int N, typename T> struct tFunction : public FunctionBase<N>
 	// calls to this method will refine previous calls by subdividing the sample points.
 	// This allows the method to be used adaptively until the error is limited to within
 	// a certain tolerance.
-	// Because of this, n is not the number of samples to take, but 2^(n-2) are the number
+	// Because of this, n is not the number of samples to take, but 2^(n-1) are the number
 	// of sample points to add to the current approximation.
 	float IntegrateTrapezoid(const float u0, const float u1, const int n) const
 	{
@@ -321,7 +416,7 @@ template <int N, typename T> struct tFunction : public FunctionBase<N>
 			float	sum = 0;
 
 			// Calculate the number of samples to take
-			nb_samples = (nb_samples << (n - 2));
+			nb_samples = (nb_samples << (n - 1));
 
 			// Spacing between samples
 			float h = (u1 - u0) / (float)nb_samples;
@@ -518,7 +613,7 @@ template <int N, typename T> struct tFunction : public FunctionBase<N>
 	}
 
 
-	float IntegrateRomberg(const float u0, const float u1)
+	float IntegrateRomberg(const float u0, const float u1) const
 	{
 		static const int	MAX_NB_EVALS = 10;
 		static const int	K = 5;				// How many successive trapezoid results to
@@ -562,42 +657,33 @@ template <int N, typename T> struct tFunction : public FunctionBase<N>
 
 	float GaussianQuadrature(const float u0, const float u1) const
 	{
-		// Table of abscissas (N = 10, weighted around midpoint, so only 5)
-		static float x[5] =
-		{
-			0.1488743389f,
-			0.4333953941f,
-			0.6794095682f,
-			0.8650633666f,
-			0.9739065285f
-		};
-
-		// Table of weights per sample
-		static float w[5] =
-		{
-			0.2955242247f,
-			0.2692667193f,
-			0.2199863625f,
-			0.1494513491f,
-			0.0666713443f
-		};
-
 		// Calculate parametric mid-point and range either side of it
 		float mid_point = 0.5f * (u0 + u1);
 		float range = mid_point - u0;
 
-		// Will be twice the average value of the function since the ten weights
-		// (5 weights used twice) sum to 2.
-		float s = 0;
-
+		// Get all the sample points either side of the mid-point and evaluate them together,
+		// padded out to a multiple of four with two at the mid-point that are never summed
+		float u[12], f[12];
 		for (int i = 0; i < 5; i++)
 		{
-			// Get sample point either side of the mid-point
-			float dx = range * x[i];
-
-			// Sum the weighted sample values
-			s += w[i] * (EvalIntFunc(mid_point + dx) + EvalIntFunc(mid_point - dx));
+			u[i * 2] = mid_point + range * g_GaussAbscissas[i];
+			u[i * 2 + 1] = mid_point - range * g_GaussAbscissas[i];
 		}
+		u[10] = u[11] = mid_point;
+
+#ifdef	ARCLENGTH_SSE
+		// Padding fills out the last register so it costs nothing extra
+		EvalIntFuncs(u, f, 12);
+#else
+		EvalIntFuncs(u, f, 10);
+#endif
+
+		// Will be twice the average value of the function since the ten weights sum to 2.
+		float s = 0;
+
+		// Sum the weighted sample values
+		for (int i = 0; i < 10; i++)
+			s += g_GaussWeights[i >> 1] * f[i];
 
 		// Scale result to integration range
 		return (s * range);
@@ -605,10 +691,23 @@ template <int N, typename T> struct tFunction : public FunctionBase<N>
 
 
 	void InitTableAdaptiveGaussian(const float tolerance, const float max_dist)
+	{
+		// Replace any previous table
+		delete [] arc_lengths;
+		arc_lengths = BuildTableAdaptiveGaussian(0, 1, tolerance, max_dist, nb_entries);
+		UpdatePositionCache();
+	}
+
+
+	// Adaptively build the parameter/arc-length pairs for just the [u0, u1] range of the
+	// curve, with arc-lengths measured from u0. Separate ranges can be built in parallel and
+	// joined by offsetting each by the total length of the ranges before it. The returned
+	// table is allocated with new[] and belongs to the caller.
+	float* BuildTableAdaptiveGaussian(const float u0, const float u1, const float tolerance, const float max_dist, int& count) const
 	{
 		struct Segment
 		{
-			static void Process(tFunction<N, T>* f_ptr, const float min_u, const float max_u, const float max_dist, const float tolerance, Pair* pairs)
+			static Pair* Process(const tFunction<N, T>* f_ptr, const float min_u, const float max_u, const float max_dist, const float tolerance, Pair* last)
 			{
 				// Get parameteric values for the endpoints and midpoint
 				float u[3] =
@@ -629,50 +728,331 @@ template <int N, typename T> struct tFunction : public FunctionBase<N>
 				// Too much error?
 				if (u[2] - u[1] >= max_dist || fabs(l[0] + l[1] - l[2]) > tolerance)
 				{
-					// Further split the two halves of this segment
-					Process(f_ptr, u[0], u[1], max_dist, tolerance, pairs);
-					Process(f_ptr, u[1], u[2], max_dist, tolerance, pairs);
+					// Further split the two halves of this segment, in order
+					last = Process(f_ptr, u[0], u[1], max_dist, tolerance, last);
+					return (Process(f_ptr, u[1], u[2], max_dist, tolerance, last));
 				}
 
-				// Just fine...
-				else
-				{
-					// Add the midpoint
-					tFunction<N, T>::Pair::Add(pairs, u[1], l[0]);
-					tFunction<N, T>::Pair::Add(pairs, u[2], l[1]);
-				}
+				// Just fine, add the midpoint and end which always come after everything
+				// already in the list
+				last = tFunction<N, T>::Pair::Append(last, u[1], l[0]);
+				return (tFunction<N, T>::Pair::Append(last, u[2], l[1]));
 			}
 		};
 
-		// Create the top of the linked pair list, contains the <0, 0> entry
+		// Create the top of the linked pair list, contains the <u0, 0> entry
 		Pair* pairs = new Pair;
-		pairs->u = 0;
+		pairs->u = u0;
 		pairs->s = 0;
 		pairs->next = 0;
 
-		Segment::Process(this, 0, 1, max_dist, tolerance, pairs);
+		Segment::Process(this, u0, u1, max_dist, tolerance, pairs);
 
+		return (BuildTableFromPairs(pairs, count));
+	}
+
+
+	// Turns a list of pairs holding the arc-length of each interval into a table of running
+	// totals, releasing the list
+	static float* BuildTableFromPairs(Pair* pairs, int& count)
+	{
 		// Count the number of entries in the table
-		nb_entries = 0;
+		count = 0;
 		Pair* cur;
 		for (cur = pairs; cur; cur = cur->next)
-			nb_entries++;
+			count++;
 
-		// Allocate the table
-		arc_lengths = new float[2 * nb_entries];
+		float* table = new float[2 * count];
 
 		// Fill in the start entry
-		arc_lengths[0] = 0;
-		arc_lengths[1] = 0;
+		table[0] = pairs->u;
+		table[1] = 0;
 
 		// Copy all entries after the first, summing the arc-lengths along the way
-		nb_entries = 1;
-		for (cur = pairs->next; cur; cur = cur->next)
+		int i = 1;
+		for (cur = pairs->next; cur; cur = cur->next, i++)
 		{
-			arc_lengths[nb_entries * 2 + 0] = cur->u;
-			arc_lengths[nb_entries * 2 + 1] = cur->s + arc_lengths[nb_entries * 2 - 1];
-			nb_entries++;
+			table[i * 2 + 0] = cur->u;
+			table[i * 2 + 1] = cur->s + table[i * 2 - 1];
+		}
+
+		// Release the pair list
+		while (pairs)
+		{
+			cur = pairs->next;
+			delete pairs;
+			pairs = cur;
+		}
+
+		return (table);
+	}
+
+
+	// Interpolation schemes a table can be built for by InitTableCurvature(), or decimated
+	// for by DecimateTable()
+	enum
+	{
+		// The lerped lookups, GetArcLengthLerpedAdaptive() and GetParameterLerped()
+		SPLIT_LERP,
+
+		// Cubic Hermite positions from a position cache that stores tangents
+		SPLIT_HERMITE
+	};
+
+
+	// Predicts the error of interpolating across the [u0, u1] interval, whose arc-length is
+	// already known, from the rate of change of speed and the curvature at its ends and
+	// quarters. Lerping the arc-length is out by at most |s''| du^2 / 8, where s'' is the
+	// derivative of the speed, and as the lerped parameter lands the same distance away
+	// along the curve that covers both lookups. Hermite interpolation by arc-length is out
+	// by |P''''| ds^4 / 384, where P'''' is the second derivative of the curvature vector
+	// with respect to arc-length. That's estimated from the change in the curvature vector
+	// across the interval, but can't be less than k^3 for curvature k, its value on a
+	// circular arc.
+	float PredictInterpolationError(const float u0, const float u1, const float length, const int scheme) const
+	{
+		float max_accel = 0, max_curvature = 0;
+		Point<N> curvature[5];
+
+		int i;
+		for (i = 0; i < 5; i++)
+		{
+			CurveSample<N> sample = Evaluate(u0 + (u1 - u0) * (float)i / 4, 2);
+
+			float speed_sq = sample.d1.Dot(sample.d1);
+			if (speed_sq > 0)
+			{
+				float d1d2 = sample.d1.Dot(sample.d2);
+				float accel = (float)fabs(d1d2) / (float)sqrt(speed_sq);
+				if (accel > max_accel)
+					max_accel = accel;
+
+				// Part of the second differential at right angles to the direction of travel,
+				// scaled to be per unit arc-length
+				curvature[i] = (sample.d2 - sample.d1 * (d1d2 / speed_sq)) * (1 / speed_sq);
+			}
+			else
+			{
+				curvature[i] = sample.d1;
+			}
+
+			float k = curvature[i].Length();
+			if (k > max_curvature)
+				max_curvature = k;
+		}
+
+		if (scheme == SPLIT_LERP)
+			return (max_accel * (u1 - u0) * (u1 - u0) / 8);
+
+		// Largest second difference of the curvature vector over the quarters
+		float length_sq = length * length;
+		float fourth = 0;
+		for (i = 1; i < 4 && length_sq > 0; i++)
+		{
+			float d = (curvature[i - 1] - curvature[i] * 2 + curvature[i + 1]).Length() * 16 / length_sq;
+			if (d > fourth)
+				fourth = d;
+		}
+
+		if (fourth < max_curvature * max_curvature * max_curvature)
+			fourth = max_curvature * max_curvature * max_curvature;
+
+		return (fourth * length_sq * length_sq / 384);
+	}
+
+
+	// Adaptive table with the fewest entries that keep the predicted interpolation error of
+	// the given scheme within max_error, rather than splitting on the arc-length estimate
+	// and a fixed maximum spacing. The arc-lengths themselves come from Gaussian quadrature,
+	// as with InitTableAdaptiveGaussian().
+	void InitTableCurvature(const float max_error, const int scheme)
+	{
+		// Replace any previous table
+		delete [] arc_lengths;
+		arc_lengths = BuildTableCurvature(0, 1, max_error, scheme, nb_entries);
+		UpdatePositionCache();
+	}
+
+
+	// Builds the table for just the [u0, u1] range, as BuildTableAdaptiveGaussian() does
+	float* BuildTableCurvature(const float u0, const float u1, const float max_error, const int scheme, int& count) const
+	{
+		struct Segment
+		{
+			static Pair* Process(const tFunction<N, T>* f_ptr, const float min_u, const float max_u, const float max_error, const int scheme, Pair* last)
+			{
+				float length = f_ptr->GaussianQuadrature(min_u, max_u);
+				float du = max_u - min_u;
+
+				// The curve is only sampled five times per interval so don't trust it over
+				// more than a quarter of the range. Stop splitting somewhere sensible if the
+				// curve stops dead and the curvature blows up.
+				if (du > 0.25f || (du > 1.0f / 65536 && f_ptr->PredictInterpolationError(min_u, max_u, length, scheme) > max_error))
+				{
+					float mid_u = (min_u + max_u) / 2;
+					last = Process(f_ptr, min_u, mid_u, max_error, scheme, last);
+					return (Process(f_ptr, mid_u, max_u, max_error, scheme, last));
+				}
+
+				return (tFunction<N, T>::Pair::Append(last, max_u, length));
+			}
+		};
+
+		// Create the top of the linked pair list, contains the <u0, 0> entry
+		Pair* pairs = new Pair;
+		pairs->u = u0;
+		pairs->s = 0;
+		pairs->next = 0;
+
+		Segment::Process(this, u0, u1, max_error, scheme, pairs);
+
+		return (BuildTableFromPairs(pairs, count));
+	}
+
+
+	// Removes the table entries that the given interpolation scheme can do without, keeping
+	// the lookup error within max_error. Douglas-Peucker style: the span between two kept
+	// entries is checked against the curve at every entry it covers and every midpoint of
+	// the intervals between them, and split at the worst if any are out by too much. The
+	// midpoints are measured with Gaussian quadrature so the check is against the curve
+	// itself rather than the table. Returns the number of entries removed.
+	//
+	// GetParameterNewtonRaphson() starts from a lerped guess, so decimate for SPLIT_LERP
+	// when using it: SPLIT_HERMITE leaves too few entries for two iterations to converge.
+	// SPLIT_HERMITE checks against the curve's own tangents, so it needs a CACHE_TANGENTS
+	// position cache: tangents estimated from the neighbouring entries get much worse as
+	// the entries are spread out. Only for adaptive tables, as the uniform lookups of
+	// InitTable() need the entries evenly spaced.
+	int DecimateTable(const float max_error, const int scheme)
+	{
+		if (scheme == SPLIT_HERMITE && cache_mode != CACHE_TANGENTS)
+			throw cException("DecimateTable: SPLIT_HERMITE needs a CACHE_TANGENTS position cache");
+
+		int nb_intervals = nb_entries - 1;
+
+		// Arc-lengths at the middle of each interval to check against
+		float* mid_lengths = new float[nb_intervals];
+		int i;
+		for (i = 0; i < nb_intervals; i++)
+		{
+			float u0 = arc_lengths[i * 2];
+			mid_lengths[i] = arc_lengths[i * 2 + 1] + GaussianQuadrature(u0, (u0 + arc_lengths[i * 2 + 2]) / 2);
 		}
+
+		bool* keep = new bool[nb_entries];
+		for (i = 0; i < nb_entries; i++)
+			keep[i] = false;
+		keep[0] = true;
+		keep[nb_entries - 1] = true;
+
+		// Spans waiting to be checked, there can't be more than one per entry
+		int* stack = new int[nb_entries * 2];
+		int nb_stacked = 0;
+		stack[nb_stacked++] = 0;
+		stack[nb_stacked++] = nb_entries - 1;
+
+		while (nb_stacked)
+		{
+			int last = stack[--nb_stacked];
+			int first = stack[--nb_stacked];
+
+			// Find the worst of the entries and midpoints within, with entries at even
+			// points and midpoints at odd ones
+			int worst = 0;
+			float worst_error = 0;
+			for (int j = first * 2 + 1; j < last * 2; j++)
+			{
+				float u, s;
+				if (j & 1)
+				{
+					u = (arc_lengths[(j >> 1) * 2] + arc_lengths[(j >> 1) * 2 + 2]) / 2;
+					s = mid_lengths[j >> 1];
+				}
+				else
+				{
+					u = arc_lengths[j];
+					s = arc_lengths[j + 1];
+				}
+
+				float error = GetSpanError(first, last, u, s, scheme);
+				if (error > worst_error)
+				{
+					worst = j;
+					worst_error = error;
+				}
+			}
+
+			if (worst_error <= max_error || last - first < 2)
+				continue;
+
+			// Split at the worst entry, or the entry nearest the worst midpoint
+			int split = worst >> 1;
+			if (split == first)
+				split++;
+
+			keep[split] = true;
+			stack[nb_stacked++] = first;
+			stack[nb_stacked++] = split;
+			stack[nb_stacked++] = split;
+			stack[nb_stacked++] = last;
+		}
+
+		// Copy the kept entries into a table of their own so the memory is really given back
+		int nb_kept = 0;
+		for (i = 0; i < nb_entries; i++)
+		{
+			if (keep[i])
+				nb_kept++;
+		}
+
+		float* table = new float[nb_kept * 2];
+		float* entry = table;
+		for (i = 0; i < nb_entries; i++)
+		{
+			if (keep[i])
+			{
+				entry[0] = arc_lengths[i * 2 + 0];
+				entry[1] = arc_lengths[i * 2 + 1];
+				entry += 2;
+			}
+		}
+
+		delete [] arc_lengths;
+		arc_lengths = table;
+
+		int nb_removed = nb_entries - nb_kept;
+		nb_entries = nb_kept;
+
+		delete [] stack;
+		delete [] keep;
+		delete [] mid_lengths;
+
+		UpdatePositionCache();
+
+		return (nb_removed);
+	}
+
+
+	// Error of interpolating from just the first and last entries to the point with the given
+	// parameter and arc-length
+	float GetSpanError(const int first, const int last, const float u, const float s, const int scheme) const
+	{
+		float u0 = arc_lengths[first * 2 + 0];
+		float l0 = arc_lengths[first * 2 + 1];
+		float u1 = arc_lengths[last * 2 + 0];
+		float l1 = arc_lengths[last * 2 + 1];
+
+		if (scheme == SPLIT_LERP)
+			return ((float)fabs(l0 + (u - u0) / (u1 - u0) * (l1 - l0) - s));
+
+		CurveSample<N> sample0 = Evaluate(u0, 1);
+		CurveSample<N> sample1 = Evaluate(u1, 1);
+
+		float h = l1 - l0;
+		float t = h > 0 ? (s - l0) / h : 0;
+		Point<N> p = InterpolateHermite(sample0.position, sample0.GetTangent(), sample1.position, sample1.GetTangent(), h, t);
+
+		return (p.DistanceFrom(Position(u)));
 	}
 
 
@@ -726,12 +1106,256 @@ template <int N, typename T> struct tFunction : public FunctionBase<N>
 	}
 
 
+	// The most accurate mappings each way, used for the static interface and the batched
+	// queries in FunctionBase
+	float GetArcLength(const float u) const
+	{
+		return (GetArcLengthAdaptiveGaussian(u));
+	}
+
+
+	float GetParameter(const float s) const
+	{
+		return (GetParameterNewtonRaphson(s));
+	}
+
+
+	// Stores the position at every table entry, along with the unit tangent when asked for,
+	// so that GetPositionAtArcLength() can get away with a table search and a cubic Hermite
+	// interpolation instead of a Newton-Raphson inversion followed by evaluating the curve.
+	// Good for followers that only need to be roughly in the right place; how roughly
+	// depends on the spacing of the table entries. The cache is built from the current
+	// table and built again by everything that replaces the table.
+	void InitPositionCache(const int mode)
+	{
+		// Replace any previous cache
+		delete [] position_cache;
+		position_cache = 0;
+
+		cache_mode = mode;
+		if (mode == CACHE_NONE)
+			return;
+
+		int stride = GetPositionCacheStride();
+		position_cache = new float[nb_entries * stride];
+
+		for (int i = 0; i < nb_entries; i++)
+		{
+			float* entry = position_cache + i * stride;
+
+			CurveSample<N> sample = Evaluate(arc_lengths[i * 2], mode == CACHE_TANGENTS ? 1 : 0);
+
+			int j;
+			for (j = 0; j < N; j++)
+				entry[j] = sample.position.values[j];
+
+			// Tangents are per unit arc-length, matching the table's spacing
+			if (mode == CACHE_TANGENTS)
+			{
+				Point<N> tangent = sample.GetTangent();
+				for (j = 0; j < N; j++)
+					entry[N + j] = tangent.values[j];
+			}
+		}
+	}
+
+
+	// Builds any position cache again for the current table. Everything that replaces the
+	// table calls this, as the cache was for the old entries.
+	void UpdatePositionCache(void)
+	{
+		if (position_cache)
+			InitPositionCache(cache_mode);
+	}
+
+
+	// Bytes used by the position cache, zero when there isn't one
+	int GetPositionCacheSize(void) const
+	{
+		return (position_cache ? nb_entries * GetPositionCacheStride() * (int)sizeof(float) : 0);
+	}
+
+
+	Point<N> GetPositionAtArcLength(const float s) const
+	{
+		// Exact without a cache
+		if (position_cache == 0)
+			return (Position(GetParameter(s)));
+
+		// Search for the arc-lengths either side of the requested one
+		int i = BinarySearch(s, 1);
+		float l0 = arc_lengths[i * 2 + 1];
+		float l1 = arc_lengths[i * 2 + 3];
+
+		// Interpolation parameter within the interval
+		float h = l1 - l0;
+		float t = h > 0 ? (s - l0) / h : 0;
+
+		Point<N> p0, p1, m0, m1;
+		GetCachedEntry(i, p0, m0);
+		GetCachedEntry(i + 1, p1, m1);
+
+		return (InterpolateHermite(p0, m0, p1, m1, h, t));
+	}
+
+
+	// Cubic Hermite interpolation between two points over an interval of arc-length h, with
+	// the tangents per unit arc-length scaled to per unit t
+	static Point<N> InterpolateHermite(const Point<N>& p0, const Point<N>& m0, const Point<N>& p1, const Point<N>& m1, const float h, const float t)
+	{
+		float t2 = t * t;
+		float t3 = t2 * t;
+		float h00 = 2 * t3 - 3 * t2 + 1;
+		float h10 = t3 - 2 * t2 + t;
+		float h01 = 3 * t2 - 2 * t3;
+		float h11 = t3 - t2;
+
+		return (p0 * h00 + m0 * (h10 * h) + p1 * h01 + m1 * (h11 * h));
+	}
+
+
+	// Walks forward through the table once, calling emit(u, P(u)) for count samples placed
+	// at equal arc-length intervals starting at s0. The bracket is carried from one sample to
+	// the next rather than being searched for again, and each Newton-Raphson inversion only
+	// integrates from the previous sample, whose arc-length is already known exactly, so
+	// the quadrature interval stays short.
+	template <typename E> int Resample(const float s0, const float spacing, const int count, E& emit) const
+	{
+		// Total arc-length of the curve
+		float length = arc_lengths[(nb_entries - 1) * 2 + 1];
+
+		// Convergence limit for the Newton-Raphson steps
+		float tolerance = 1e-6f * length;
+
+		// Only one search for the entire sweep
+		int index = BinarySearch(s0 < 0 ? 0 : s0, 1);
+
+		// The anchor is the last point with an exactly known arc-length
+		float anchor_u = arc_lengths[index * 2 + 0];
+		float anchor_s = arc_lengths[index * 2 + 1];
+
+		for (int i = 0; i < count; i++)
+		{
+			// Keep the sample on the curve
+			float s = s0 + spacing * i;
+			if (s < 0) s = 0;
+			if (s > length) s = length;
+
+			// Step the bracket forward, resetting the anchor to the table entry
+			while (index < nb_entries - 2 && arc_lengths[index * 2 + 3] <= s)
+			{
+				index++;
+				anchor_u = arc_lengths[index * 2 + 0];
+				anchor_s = arc_lengths[index * 2 + 1];
+			}
+
+			// Get parameters either side of the bracket and the arc-length at its top
+			float v0 = arc_lengths[index * 2 + 0];
+			float v1 = arc_lengths[index * 2 + 2];
+			float l1 = arc_lengths[index * 2 + 3];
+
+			// Initial guess is a lerp between the anchor and the top of the bracket
+			float p = anchor_u;
+			if (l1 > anchor_s)
+				p += (s - anchor_s) / (l1 - anchor_s) * (v1 - anchor_u);
+
+			// Refine with Newton-Raphson, keeping the integral at the final guess so that
+			// it can become the next anchor. Every later sample starts from this one, so
+			// stop at a cusp where the speed vanishes and never leave the bracket.
+			float integral = GaussianQuadrature(anchor_u, p);
+			for (int j = 0; j < 3; j++)
+			{
+				float f = s - anchor_s - integral;
+				if (fabs(f) <= tolerance)
+					break;
+
+				float speed = EvalIntFunc(p);
+				if (speed <= 1e-6f)
+					break;
+
+				p = p + f / speed;
+				if (p < v0) p = v0;
+				if (p > v1) p = v1;
+
+				integral = GaussianQuadrature(anchor_u, p);
+			}
+
+			emit(p, Position(p));
+
+			// Next sample integrates from here
+			anchor_s += integral;
+			anchor_u = p;
+		}
+
+		return (count);
+	}
+
+
+	// Emit samples every spacing units of arc-length from s0 up to s1
+	template <typename E> int ResampleSpacing(const float spacing, const float s0, const float s1, E& emit) const
+	{
+		if (spacing <= 0 || s1 < s0)
+			return (0);
+
+		return (Resample(s0, spacing, (int)((s1 - s0) / spacing + 1e-4f) + 1, emit));
+	}
+
+
+	// Emit exactly count samples, the first at s0 and the last at s1
+	template <typename E> int ResampleCount(const int count, const float s0, const float s1, E& emit) const
+	{
+		return (Resample(s0, count > 1 ? (s1 - s0) / (float)(count - 1) : 0, count, emit));
+	}
+
+
+	int GetPositionCacheStride(void) const
+	{
+		return (cache_mode == CACHE_TANGENTS ? N * 2 : N);
+	}
+
+
+	// Position and tangent at a table entry from the cache, estimating the tangent from the
+	// entries either side when it's not stored
+	void GetCachedEntry(const int i, Point<N>& p, Point<N>& m) const
+	{
+		int stride = GetPositionCacheStride();
+		const float* entry = position_cache + i * stride;
+
+		int j;
+		for (j = 0; j < N; j++)
+			p.values[j] = entry[j];
+
+		if (cache_mode == CACHE_TANGENTS)
+		{
+			for (j = 0; j < N; j++)
+				m.values[j] = entry[N + j];
+			return;
+		}
+
+		// Central difference, one-sided at the ends of the table
+		int i0 = i > 0 ? i - 1 : i;
+		int i1 = i < nb_entries - 1 ? i + 1 : i;
+		const float* e0 = position_cache + i0 * stride;
+		const float* e1 = position_cache + i1 * stride;
+
+		float ds = arc_lengths[i1 * 2 + 1] - arc_lengths[i0 * 2 + 1];
+		float scale = ds > 0 ? 1 / ds : 0;
+		for (j = 0; j < N; j++)
+			m.values[j] = (e1[j] - e0[j]) * scale;
+	}
+
+
 	T curve[N];
 
 	int		nb_entries;
 
 	float*	arc_lengths;
 
+	// Optional positions, and maybe tangents, for each table entry
+	float*	position_cache;
+
+	int		cache_mode;
+
 	float	entry_distance;
 
 	mutable float	last_eval;
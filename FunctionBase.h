@@ -18,6 +18,61 @@ template <int N> struct FunctionBase
 
 	// Analytically compute length of the curve
 	virtual float L(const float u0, const float u1) const = 0;
+
+	// Batched queries, for working through collections of different curve types with one
+	// virtual call per array rather than one per sample
+	virtual void GetPositions(const float* u, Point<N>* p, const int count) const = 0;
+	virtual void GetArcLengths(const float* u, float* s, const int count) const = 0;
+	virtual void GetParameters(const float* s, float* u, const int count) const = 0;
+};
+
+
+// Static interface for curve types, which derive from this passing themselves as F and
+// provide these non-virtual methods:
+//
+//		Point<N> Position(const float u) const;
+//		float GetArcLength(const float u) const;
+//		float GetParameter(const float s) const;
+//
+// Code that is templated on the curve type calls them directly so that they can be inlined
+// into its loops. Everything else goes through FunctionBase, whose methods are implemented
+// here in terms of them.
+template <int N, typename F> struct tFunctionDispatch : public FunctionBase<N>
+{
+	Point<N> P(const float u) const
+	{
+		return (Self().Position(u));
+	}
+
+
+	void GetPositions(const float* u, Point<N>* p, const int count) const
+	{
+		const F& f = Self();
+		for (int i = 0; i < count; i++)
+			p[i] = f.Position(u[i]);
+	}
+
+
+	void GetArcLengths(const float* u, float* s, const int count) const
+	{
+		const F& f = Self();
+		for (int i = 0; i < count; i++)
+			s[i] = f.GetArcLength(u[i]);
+	}
+
+
+	void GetParameters(const float* s, float* u, const int count) const
+	{
+		const F& f = Self();
+		for (int i = 0; i < count; i++)
+			u[i] = f.GetParameter(s[i]);
+	}
+
+
+	const F& Self(void) const
+	{
+		return (*static_cast<const F*>(this));
+	}
 };
 
 
@@ -0,0 +1,322 @@
+
+#ifndef	_INCLUDED_LAZYTABLE_H
+#define	_INCLUDED_LAZYTABLE_H
+
+
+#ifndef	_INCLUDED_SDLAATOMIC_H
+	#include <SDLAAtomic.h>
+#endif
+
+#ifndef	_INCLUDED_FUNCTION_H
+	#include "Function.h"
+#endif
+
+
+// Arc-length lookups for a curve whose adaptive table is only built where it's needed, for
+// levels full of curves that mostly never get used. Nothing at all is built until the first
+// query, which measures a coarse table of equal parameter intervals. Then the first query
+// to land in each interval builds the full adaptive table for it, with the same tolerance
+// and maximum distance as InitTableAdaptiveGaussian(). So the time spent building and the
+// memory held grow with how much of the level is actually visited rather than how much
+// there is of it.
+//
+// Queries can come from any number of threads at once without locking. The coarse table
+// and each interval's table are published with a single compare and swap of a pointer: two
+// threads that need the same one at once may both build it, but only one wins and the
+// other is thrown away, and everyone uses the winner from then on.
+//
+// Each refined table is scaled very slightly to end at its interval's coarse length, so the
+// arc-length along the curve is fixed by the coarse table and never moves as intervals are
+// refined. The function is referenced rather than copied and has to outlive this.
+template <int N, typename T> class tLazyTable : public tFunctionDispatch<N, tLazyTable<N, T> >
+{
+public:
+	typedef tFunction<N, T> Function;
+
+
+	tLazyTable(const Function& function, const float tolerance, const float max_dist, const int nb_intervals = 8) :
+
+		m_Function(function),
+		m_Tolerance(tolerance),
+		m_MaxDist(max_dist),
+		m_NbIntervals(nb_intervals),
+		m_Coarse(0),
+		m_NbRefined(0)
+
+	{
+	}
+
+
+	~tLazyTable(void)
+	{
+		Coarse* coarse = (Coarse*)m_Coarse;
+		if (coarse == 0)
+			return;
+
+		for (int i = 0; i < m_NbIntervals; i++)
+		{
+			Refinement* refinement = (Refinement*)coarse->refined[i];
+			if (refinement)
+			{
+				delete [] refinement->table;
+				delete refinement;
+			}
+		}
+
+		DeleteCoarse(coarse);
+	}
+
+
+	Point<N> Position(const float u) const
+	{
+		return (m_Function.Position(u));
+	}
+
+
+	// Same as GetArcLengthAdaptiveGaussian() on the full table
+	float GetArcLength(const float u) const
+	{
+		const Coarse* coarse = GetCoarse();
+
+		// Intervals are evenly spaced so there's no need to search for this one
+		int i = (int)(u * (float)m_NbIntervals);
+		if (i < 0) i = 0;
+		if (i > m_NbIntervals - 1) i = m_NbIntervals - 1;
+
+		const Refinement* refinement = GetRefinement(coarse, i);
+		const float* entry = refinement->table + Search(refinement->table, refinement->count, u, 0) * 2;
+
+		return (coarse->lengths[i] + entry[1] + m_Function.GaussianQuadrature(entry[0], u) * refinement->scale);
+	}
+
+
+	// Same as GetParameterNewtonRaphson() on the full table
+	float GetParameter(const float s) const
+	{
+		const Coarse* coarse = GetCoarse();
+		int i = Search(coarse->lengths, m_NbIntervals + 1, s);
+
+		const Refinement* refinement = GetRefinement(coarse, i);
+		const float* table = refinement->table;
+		int index = Search(table, refinement->count, s - coarse->lengths[i], 1);
+
+		// Get parameters and arc-lengths on either side, measured from the start of the curve
+		float v0 = table[index * 2];
+		float v1 = table[index * 2 + 2];
+		float l0 = coarse->lengths[i] + table[index * 2 + 1];
+		float l1 = coarse->lengths[i] + table[index * 2 + 3];
+
+		// Initial guess is a lerp between the parameters
+		float t = (s - l0) / (l1 - l0);
+		float p = v0 + t * (v1 - v0);
+
+		// Two Newton-Raphson iterations, as with the full table
+		for (int j = 0; j < 2; j++)
+		{
+			float f = s - l0 - m_Function.GaussianQuadrature(v0, p) * refinement->scale;
+			float fd = -m_Function.EvalIntFunc(p) * refinement->scale;
+			p = p - f / fd;
+		}
+
+		return (p);
+	}
+
+
+	float L(const float u0, const float u1) const
+	{
+		return (GetArcLength(u1) - GetArcLength(u0));
+	}
+
+
+	// Total length of the curve, which only needs the coarse table rather than refining
+	// the intervals at either end as L(0, 1) would
+	float GetLength(void) const
+	{
+		return (GetCoarse()->lengths[m_NbIntervals]);
+	}
+
+
+	// Number of intervals whose table has been built so far, out of GetNbIntervals()
+	int GetNbRefined(void) const
+	{
+		return ((int)SDLAAtomicLoad(&m_NbRefined));
+	}
+
+
+	int GetNbIntervals(void) const
+	{
+		return (m_NbIntervals);
+	}
+
+
+	// Bytes held for the coarse table and all the refined ones so far
+	int GetMemoryUsage(void) const
+	{
+		const Coarse* coarse = (const Coarse*)SDLAAtomicLoadPointer(&m_Coarse);
+		if (coarse == 0)
+			return (0);
+
+		int bytes = sizeof(Coarse) + (m_NbIntervals + 1) * sizeof(float) + m_NbIntervals * sizeof(void*);
+		for (int i = 0; i < m_NbIntervals; i++)
+		{
+			const Refinement* refinement = (const Refinement*)SDLAAtomicLoadPointer(&coarse->refined[i]);
+			if (refinement)
+				bytes += sizeof(Refinement) + refinement->count * 2 * sizeof(float);
+		}
+
+		return (bytes);
+	}
+
+
+private:
+	struct Coarse
+	{
+		// Arc-length at the start of each interval, plus the total at the end
+		float*	lengths;
+
+		// Table for each interval once built, or null
+		void* volatile*	refined;
+	};
+
+
+	// Full table for one interval, with arc-lengths measured from its start
+	struct Refinement
+	{
+		float*	table;
+		int		count;
+
+		// Fits the quadrature within this interval to its coarse length
+		float	scale;
+	};
+
+
+	float GetIntervalStart(const int i) const
+	{
+		return ((float)i / (float)m_NbIntervals);
+	}
+
+
+	// The coarse table, measuring it if this is the first time anyone's asked
+	const Coarse* GetCoarse(void) const
+	{
+		Coarse* coarse = (Coarse*)SDLAAtomicLoadPointer(&m_Coarse);
+		if (coarse)
+			return (coarse);
+
+		coarse = new Coarse;
+		coarse->lengths = new float[m_NbIntervals + 1];
+		coarse->refined = new void* volatile[m_NbIntervals];
+
+		// Quadrature over halves of each interval, which are already much shorter than
+		// most intervals of a full table
+		coarse->lengths[0] = 0;
+		for (int i = 0; i < m_NbIntervals; i++)
+		{
+			float u0 = GetIntervalStart(i);
+			float u1 = GetIntervalStart(i + 1);
+			float mid_u = (u0 + u1) / 2;
+
+			coarse->lengths[i + 1] = coarse->lengths[i] + m_Function.GaussianQuadrature(u0, mid_u) + m_Function.GaussianQuadrature(mid_u, u1);
+			coarse->refined[i] = 0;
+		}
+
+		// Publish it unless another thread got there first, in which case use theirs
+		Coarse* seen = (Coarse*)SDLAAtomicCompareExchangePointer(&m_Coarse, coarse, 0);
+		if (seen)
+		{
+			DeleteCoarse(coarse);
+			return (seen);
+		}
+
+		return (coarse);
+	}
+
+
+	// The table for an interval, building it if this is the first time anyone's asked
+	const Refinement* GetRefinement(const Coarse* coarse, const int i) const
+	{
+		Refinement* refinement = (Refinement*)SDLAAtomicLoadPointer(&coarse->refined[i]);
+		if (refinement)
+			return (refinement);
+
+		refinement = new Refinement;
+		refinement->table = m_Function.BuildTableAdaptiveGaussian(GetIntervalStart(i), GetIntervalStart(i + 1), m_Tolerance, m_MaxDist, refinement->count);
+
+		// Make the table end exactly at the interval's coarse length
+		float length = refinement->table[refinement->count * 2 - 1];
+		refinement->scale = length > 0 ? (coarse->lengths[i + 1] - coarse->lengths[i]) / length : 1;
+		for (int j = 0; j < refinement->count; j++)
+			refinement->table[j * 2 + 1] *= refinement->scale;
+
+		Refinement* seen = (Refinement*)SDLAAtomicCompareExchangePointer(&coarse->refined[i], refinement, 0);
+		if (seen)
+		{
+			delete [] refinement->table;
+			delete refinement;
+			return (seen);
+		}
+
+		SDLAAtomicIncrement(&m_NbRefined);
+		return (refinement);
+	}
+
+
+	static void DeleteCoarse(Coarse* coarse)
+	{
+		delete [] coarse->refined;
+		delete [] coarse->lengths;
+		delete coarse;
+	}
+
+
+	// Binary search through an ascending table of pairs for the entry at or below v
+	static int Search(const float* table, const int count, const float v, const int offset)
+	{
+		int min_i = 0, max_i = count - 1;
+
+		while (max_i - min_i > 1)
+		{
+			int mid_point = (min_i + max_i) >> 1;
+			if (v >= table[mid_point * 2 + offset])
+				min_i = mid_point;
+			else
+				max_i = mid_point;
+		}
+
+		return (min_i);
+	}
+
+
+	// The same through an ascending array of single values
+	static int Search(const float* values, const int count, const float v)
+	{
+		int min_i = 0, max_i = count - 1;
+
+		while (max_i - min_i > 1)
+		{
+			int mid_point = (min_i + max_i) >> 1;
+			if (v >= values[mid_point])
+				min_i = mid_point;
+			else
+				max_i = mid_point;
+		}
+
+		return (min_i);
+	}
+
+
+	const Function&	m_Function;
+
+	float	m_Tolerance;
+	float	m_MaxDist;
+
+	int		m_NbIntervals;
+
+	// Coarse table once measured, or null
+	mutable void* volatile	m_Coarse;
+
+	mutable volatile long	m_NbRefined;
+};
+
+
+#endif	/* _INCLUDED_LAZYTABLE_H */
@@ -2,6 +2,15 @@
 #include <windows.h>
 #include <cstdio>
 #include <cassert>
+#include "../SDLApp/SDLAFontFormat.h"
+
+
+// Size of the source cell each character is rendered in, of which the top FONTDB_CELL_HEIGHT
+// rows are kept
+static const int CELL_SIZE = 32;
+
+// Width of the packed coverage pages
+static const int PAGE_WIDTH = 256;
 
 
 class cFontDB
@@ -77,23 +86,100 @@ public:
 	{
 		int	i;
 
+		// Pack the characters in rows across as few pages as possible
+		FontDBChar* chars = new FontDBChar[m_NbEntries];
+		int nb_pages = 1, x = 0, y = 0;
+		for (i = 0; i < m_NbEntries; i++)
+		{
+			const Entry& entry = m_Entries[i];
+
+			// Move onto the next row, and the next page, when out of space
+			if (x + entry.w > PAGE_WIDTH)
+			{
+				x = 0;
+				y += CELL_SIZE;
+			}
+			if (y + CELL_SIZE > PAGE_WIDTH)
+			{
+				y = 0;
+				nb_pages++;
+			}
+
+			chars[i].code = entry.code;
+			chars[i].tpage = nb_pages - 1;
+			chars[i].x = x;
+			chars[i].y = y;
+			chars[i].w = entry.w;
+			chars[i].h = FONTDB_CELL_HEIGHT;
+			chars[i].x_offset = 0;
+			chars[i].y_offset = 0;
+			chars[i].advance = entry.w;
+
+			x += entry.w;
+		}
+
+		// Shrink the pages down to the smallest power of two that holds the rows used
+		int page_height = PAGE_WIDTH;
+		if (nb_pages == 1)
+			while (page_height / 2 >= y + CELL_SIZE)
+				page_height /= 2;
+
+		// Fill in the header, with the pages aligned after the character list
+		FontDBHeader header;
+		memcpy(header.magic, FONTDB_MAGIC, 4);
+		header.version = FONTDB_VERSION;
+		header.page_width = PAGE_WIDTH;
+		header.page_height = page_height;
+		header.nb_pages = nb_pages;
+		header.nb_chars = m_NbEntries;
+		header.chars_offset = sizeof(header);
+		header.pages_offset = header.chars_offset + m_NbEntries * sizeof(FontDBChar);
+		header.pages_offset = (header.pages_offset + FONTDB_PAGE_ALIGN - 1) & ~(FONTDB_PAGE_ALIGN - 1);
+
+		// Copy the coverage of each character into its packed position
+		int page_size = PAGE_WIDTH * page_height;
+		unsigned char* pages = new unsigned char[nb_pages * page_size];
+		memset(pages, 0, nb_pages * page_size);
+		for (i = 0; i < m_NbEntries; i++)
+		{
+			const Entry& entry = m_Entries[i];
+			unsigned char* dest = pages + chars[i].tpage * page_size;
+
+			for (int py = 0; py < FONTDB_CELL_HEIGHT; py++)
+			{
+				for (int px = 0; px < entry.w; px++)
+				{
+					// The width-reduced rectangle can poke out of the side of the source
+					int sx = entry.x + px;
+					if (sx < 0 || sx >= 256)
+						continue;
+
+					// Brightest channel is the coverage
+					const unsigned char* rgb = &m_Pages[entry.tpage][((entry.y + py) * 256 + sx) * 3];
+					unsigned char c = rgb[0] > rgb[1] ? rgb[0] : rgb[1];
+					c = c > rgb[2] ? c : rgb[2];
+
+					dest[(chars[i].y + py) * PAGE_WIDTH + chars[i].x + px] = c;
+				}
+			}
+		}
+
 		// Open the font DB for writing
 		FILE* fp = fopen(filename, "wb");
 		assert(fp);
 
-		// Write the tpage count
-		fwrite(&m_NbTPages, 1, sizeof(int), fp);
-
-		// Write each texture page
-		for (i = 0; i < m_NbTPages; i++)
-			fwrite(m_Pages[i], 1, 256 * 256 * 3, fp);
-
-		// Write the entry list
-		fwrite(&m_NbEntries, 1, sizeof(int), fp);
-		fwrite(m_Entries, 1, m_NbEntries * sizeof(Entry), fp);
+		// Header, character list and then the aligned pages
+		fwrite(&header, 1, sizeof(header), fp);
+		fwrite(chars, 1, m_NbEntries * sizeof(FontDBChar), fp);
+		for (i = header.chars_offset + m_NbEntries * sizeof(FontDBChar); i < header.pages_offset; i++)
+			fputc(0, fp);
+		fwrite(pages, 1, nb_pages * page_size, fp);
 
 		// Shut up shop
 		fclose(fp);
+
+		delete [] pages;
+		delete [] chars;
 	}
 
 
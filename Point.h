@@ -3,24 +3,148 @@
 #define	_INCLUDED_POINT_H
 
 
+#include <cmath>
+
+#ifdef	ARCLENGTH_SSE
+	#include <xmmintrin.h>
+#endif
+
+
+#ifdef	ARCLENGTH_SSE
+
+// Sum of all four lanes, returned in the first
+inline __m128 SSEHorizontalSum(const __m128 v)
+{
+	__m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+	return (_mm_add_ss(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 1, 1, 1))));
+}
+
+#endif
+
+
 template <int N> struct Point
 {
+	// Padding values are always zero so that whole SSE registers can be worked on
+	Point(void)
+	{
+		for (int i = N; i < NB_LANES; i++)
+			values[i] = 0;
+	}
+
+
+	// Number of dimensions, and the number of values once padded to a multiple of four
+	enum { n = N, NB_LANES = (N + 3) & ~3 };
+
 	// Array of values in all dimensions
-	float	values[N];
+	float	values[NB_LANES];
+
+
+	Point<N> operator + (const Point<N>& p) const
+	{
+		Point<N> r;
+
+#ifdef	ARCLENGTH_SSE
+		for (int i = 0; i < NB_LANES; i += 4)
+			_mm_storeu_ps(r.values + i, _mm_add_ps(_mm_loadu_ps(values + i), _mm_loadu_ps(p.values + i)));
+#else
+		for (int i = 0; i < N; i++)
+			r.values[i] = values[i] + p.values[i];
+#endif
+
+		return (r);
+	}
+
+
+	Point<N> operator - (const Point<N>& p) const
+	{
+		Point<N> r;
+
+#ifdef	ARCLENGTH_SSE
+		for (int i = 0; i < NB_LANES; i += 4)
+			_mm_storeu_ps(r.values + i, _mm_sub_ps(_mm_loadu_ps(values + i), _mm_loadu_ps(p.values + i)));
+#else
+		for (int i = 0; i < N; i++)
+			r.values[i] = values[i] - p.values[i];
+#endif
+
+		return (r);
+	}
+
+
+	Point<N> operator * (const float s) const
+	{
+		Point<N> r;
+
+#ifdef	ARCLENGTH_SSE
+		__m128 vs = _mm_set1_ps(s);
+		for (int i = 0; i < NB_LANES; i += 4)
+			_mm_storeu_ps(r.values + i, _mm_mul_ps(_mm_loadu_ps(values + i), vs));
+#else
+		for (int i = 0; i < N; i++)
+			r.values[i] = values[i] * s;
+#endif
+
+		return (r);
+	}
+
+
+	float Dot(const Point<N>& p) const
+	{
+		float d = 0;
+
+#ifdef	ARCLENGTH_SSE
+		__m128 sum = _mm_setzero_ps();
+		for (int i = 0; i < NB_LANES; i += 4)
+			sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(values + i), _mm_loadu_ps(p.values + i)));
+		_mm_store_ss(&d, SSEHorizontalSum(sum));
+#else
+		for (int i = 0; i < N; i++)
+			d += values[i] * p.values[i];
+#endif
+
+		return (d);
+	}
+
+
+	float Length(void) const
+	{
+		return ((float)sqrt(Dot(*this)));
+	}
 
-	// Number of dimensions
-	enum { n = N };
 
 	float DistanceFrom(const Point<N>& p) const
 	{
 		float d = 0;
+
+#ifdef	ARCLENGTH_SSE
+		// Padding cancels out to zero
+		__m128 sum = _mm_setzero_ps();
+		for (int i = 0; i < NB_LANES; i += 4)
+		{
+			__m128 v = _mm_sub_ps(_mm_loadu_ps(values + i), _mm_loadu_ps(p.values + i));
+			sum = _mm_add_ps(sum, _mm_mul_ps(v, v));
+		}
+		_mm_store_ss(&d, _mm_sqrt_ss(SSEHorizontalSum(sum)));
+#else
 		for (int i = 0; i < N; i++)
 			d += (values[i] - p.values[i]) * (values[i] - p.values[i]);
 		d = (float)sqrt(d);
+#endif
 
 		return (d);
 	}
 };
 
 
-#endif	/* _INCLUDED_POINT_H */
\ No newline at end of file
+// Only three dimensions have a cross product
+inline Point<3> Cross(const Point<3>& a, const Point<3>& b)
+{
+	Point<3> r;
+	r.values[0] = a.values[1] * b.values[2] - a.values[2] * b.values[1];
+	r.values[1] = a.values[2] * b.values[0] - a.values[0] * b.values[2];
+	r.values[2] = a.values[0] * b.values[1] - a.values[1] * b.values[0];
+	return (r);
+}
+
+
+#endif	/* _INCLUDED_POINT_H */
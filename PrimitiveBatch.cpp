@@ -0,0 +1,198 @@
+#include "PrimitiveBatch.h"
+#include <SDLARenderer.h>
+#include <cmath>
+#include <cstring>
+
+
+cPrimitiveBatch::cPrimitiveBatch(cSDLARenderer* renderer) :
+
+	m_Renderer(renderer),
+	m_NbGridVerts(0),
+	m_GridVerts(0)
+
+{
+	// Only place the trig is done
+	for (int i = 0; i <= NB_SUBS; i++)
+	{
+		float t = 6.2831853f * (float)(i % NB_SUBS) / (float)NB_SUBS;
+		m_Unit[i * 2 + 0] = (float)cos(t);
+		m_Unit[i * 2 + 1] = (float)sin(t);
+	}
+}
+
+
+cPrimitiveBatch::~cPrimitiveBatch(void)
+{
+	delete [] m_GridVerts;
+	delete [] m_Rings.colours;
+	delete [] m_Rings.positions;
+	delete [] m_Circles.colours;
+	delete [] m_Circles.positions;
+}
+
+
+void cPrimitiveBatch::AddCircle(const float x, const float y, const float radius, const float* colour)
+{
+	// One triangle for each subdivision of the circle
+	int first = m_Circles.Reserve(NB_SUBS * 3);
+	float* pos = &m_Circles.positions[first * 2];
+	float* col = &m_Circles.colours[first * 3];
+
+	for (int i = 0; i < NB_SUBS; i++)
+	{
+		const float* u = &m_Unit[i * 2];
+
+		// Fan from the centre out to the circumference
+		*pos++ = x;
+		*pos++ = y;
+		*pos++ = x + u[0] * radius;
+		*pos++ = y + u[1] * radius;
+		*pos++ = x + u[2] * radius;
+		*pos++ = y + u[3] * radius;
+	}
+
+	// Same colour on every vertex
+	for (int j = 0; j < NB_SUBS * 3; j++, col += 3)
+		memcpy(col, colour, 3 * sizeof(float));
+}
+
+
+void cPrimitiveBatch::AddRing(const float x, const float y, const float inner_radius, const float outer_radius, const float* colour)
+{
+	// Two triangles for each subdivision of the ring
+	int first = m_Rings.Reserve(NB_SUBS * 6);
+	float* pos = &m_Rings.positions[first * 2];
+	float* col = &m_Rings.colours[first * 3];
+
+	for (int i = 0; i < NB_SUBS; i++)
+	{
+		const float* u = &m_Unit[i * 2];
+
+		// Inner and outer points on both sides of this subdivision
+		float x0 = x + u[0] * inner_radius, y0 = y + u[1] * inner_radius;
+		float x1 = x + u[0] * outer_radius, y1 = y + u[1] * outer_radius;
+		float x2 = x + u[2] * inner_radius, y2 = y + u[3] * inner_radius;
+		float x3 = x + u[2] * outer_radius, y3 = y + u[3] * outer_radius;
+
+		*pos++ = x1; *pos++ = y1;
+		*pos++ = x0; *pos++ = y0;
+		*pos++ = x3; *pos++ = y3;
+
+		*pos++ = x3; *pos++ = y3;
+		*pos++ = x0; *pos++ = y0;
+		*pos++ = x2; *pos++ = y2;
+	}
+
+	// Same colour on every vertex
+	for (int j = 0; j < NB_SUBS * 6; j++, col += 3)
+		memcpy(col, colour, 3 * sizeof(float));
+}
+
+
+void cPrimitiveBatch::Flush(void)
+{
+	// No textures for any of the markers
+	m_Renderer->BindTexture(GL_TEXTURE_2D, 0);
+
+	// Vertices are already in world space
+	m_Renderer->MatrixMode(GL_MODELVIEW);
+	m_Renderer->LoadIdentity();
+
+	m_Renderer->EnableClientState(GL_VERTEX_ARRAY);
+	m_Renderer->EnableClientState(GL_COLOR_ARRAY);
+
+	// One draw per primitive type
+	m_Circles.Draw(m_Renderer);
+	m_Rings.Draw(m_Renderer);
+
+	m_Renderer->DisableClientState(GL_COLOR_ARRAY);
+	m_Renderer->DisableClientState(GL_VERTEX_ARRAY);
+}
+
+
+void cPrimitiveBatch::BuildGrid(const float min_x, const float max_x, const float min_y, const float max_y, const float spacing)
+{
+	float i, j;
+
+	// Count the lines in both directions
+	m_NbGridVerts = 0;
+	for (i = min_x; i < max_x; i += spacing)
+		m_NbGridVerts += 2;
+	for (j = min_y; j < max_y; j += spacing)
+		m_NbGridVerts += 2;
+
+	delete [] m_GridVerts;
+	m_GridVerts = new float[m_NbGridVerts * 2];
+	float* pos = m_GridVerts;
+
+	// Vertical lines
+	for (i = min_x; i < max_x; i += spacing)
+	{
+		*pos++ = i; *pos++ = max_y;
+		*pos++ = i; *pos++ = min_y;
+	}
+
+	// Horizontal lines
+	for (j = min_y; j < max_y; j += spacing)
+	{
+		*pos++ = min_x; *pos++ = j;
+		*pos++ = max_x; *pos++ = j;
+	}
+}
+
+
+void cPrimitiveBatch::DrawGrid(const float* colour) const
+{
+	// Set colour
+	m_Renderer->Color3fv(colour);
+
+	// Position in world space
+	m_Renderer->MatrixMode(GL_MODELVIEW);
+	m_Renderer->LoadIdentity();
+
+	m_Renderer->EnableClientState(GL_VERTEX_ARRAY);
+	m_Renderer->VertexPointer(2, GL_FLOAT, 0, m_GridVerts);
+	m_Renderer->DrawArrays(GL_LINES, 0, m_NbGridVerts);
+	m_Renderer->DisableClientState(GL_VERTEX_ARRAY);
+}
+
+
+int cPrimitiveBatch::Buffer::Reserve(const int count)
+{
+	// Grow by doubling to keep reallocation rare
+	if (nb_verts + count > max_verts)
+	{
+		int new_max = max_verts ? max_verts : 1024;
+		while (new_max < nb_verts + count)
+			new_max *= 2;
+
+		float* new_positions = new float[new_max * 2];
+		float* new_colours = new float[new_max * 3];
+		memcpy(new_positions, positions, nb_verts * 2 * sizeof(float));
+		memcpy(new_colours, colours, nb_verts * 3 * sizeof(float));
+
+		delete [] positions;
+		delete [] colours;
+		positions = new_positions;
+		colours = new_colours;
+		max_verts = new_max;
+	}
+
+	int first = nb_verts;
+	nb_verts += count;
+	return (first);
+}
+
+
+void cPrimitiveBatch::Buffer::Draw(cSDLARenderer* renderer)
+{
+	if (nb_verts == 0)
+		return;
+
+	renderer->VertexPointer(2, GL_FLOAT, 0, positions);
+	renderer->ColorPointer(3, GL_FLOAT, 0, colours);
+	renderer->DrawArrays(GL_TRIANGLES, 0, nb_verts);
+
+	// Start again for the next frame
+	nb_verts = 0;
+}
@@ -0,0 +1,66 @@
+#ifndef	_INCLUDED_PRIMITIVEBATCH_H
+#define	_INCLUDED_PRIMITIVEBATCH_H
+
+
+class cSDLARenderer;
+
+
+// Collects circles and rings over a frame and submits each primitive type with a single
+// draw call. Every instance is expanded from a precomputed unit circle so no trig is done
+// per marker, and the grid is built once into a static vertex array.
+class cPrimitiveBatch
+{
+public:
+	cPrimitiveBatch(cSDLARenderer* renderer);
+	~cPrimitiveBatch(void);
+
+	// Queue up markers for the next flush
+	void	AddCircle(const float x, const float y, const float radius, const float* colour);
+	void	AddRing(const float x, const float y, const float inner_radius, const float outer_radius, const float* colour);
+
+	// Draw all queued markers and empty the batch
+	void	Flush(void);
+
+	// Build the static grid once, then draw it whenever needed
+	void	BuildGrid(const float min_x, const float max_x, const float min_y, const float max_y, const float spacing);
+	void	DrawGrid(const float* colour) const;
+
+private:
+	struct Buffer
+	{
+		Buffer(void) : nb_verts(0), max_verts(0), positions(0), colours(0) { }
+
+		// Make space for another batch of vertices, returning the first
+		int		Reserve(const int count);
+
+		void	Draw(cSDLARenderer* renderer);
+
+		// Vertices used and allocated
+		int		nb_verts;
+		int		max_verts;
+
+		// (x, y) and (r, g, b) per vertex
+		float*	positions;
+		float*	colours;
+	};
+
+	// Number of points around the unit circle
+	enum { NB_SUBS = 32 };
+
+	// Precomputed (cos, sin) around the circle, with the first point repeated at the end
+	float	m_Unit[(NB_SUBS + 1) * 2];
+
+	// Where the batches are drawn
+	cSDLARenderer*	m_Renderer;
+
+	// Triangle lists for each primitive type
+	Buffer	m_Circles;
+	Buffer	m_Rings;
+
+	// Line list for the grid
+	int		m_NbGridVerts;
+	float*	m_GridVerts;
+};
+
+
+#endif	/* _INCLUDED_PRIMITIVEBATCH_H */
@@ -0,0 +1,148 @@
+
+#ifndef	_INCLUDED_QUATERNION_H
+#define	_INCLUDED_QUATERNION_H
+
+
+#ifndef	_INCLUDED_POINT_H
+	#include "Point.h"
+#endif
+
+
+// Unit quaternion for orientations in three dimensions, which interpolate smoothly where
+// matrices don't
+struct Quaternion
+{
+	Quaternion(void) : x(0), y(0), z(0), w(1)
+	{
+	}
+
+
+	Quaternion(const float _x, const float _y, const float _z, const float _w) : x(_x), y(_y), z(_z), w(_w)
+	{
+	}
+
+
+	// Orientation that takes the x, y and z axes onto the given ones, which must be unit
+	// length and at right angles to each other
+	static Quaternion FromAxes(const Point<3>& ax, const Point<3>& ay, const Point<3>& az)
+	{
+		// Rotation matrix has the axes as its columns
+		float m00 = ax.values[0], m01 = ay.values[0], m02 = az.values[0];
+		float m10 = ax.values[1], m11 = ay.values[1], m12 = az.values[1];
+		float m20 = ax.values[2], m21 = ay.values[2], m22 = az.values[2];
+
+		// Work from whichever of the diagonal terms is largest to keep the square root away
+		// from zero
+		float trace = m00 + m11 + m22;
+		Quaternion q;
+		if (trace > 0)
+		{
+			float r = (float)sqrt(trace + 1) * 2;
+			q = Quaternion((m21 - m12) / r, (m02 - m20) / r, (m10 - m01) / r, r / 4);
+		}
+		else if (m00 > m11 && m00 > m22)
+		{
+			float r = (float)sqrt(1 + m00 - m11 - m22) * 2;
+			q = Quaternion(r / 4, (m01 + m10) / r, (m02 + m20) / r, (m21 - m12) / r);
+		}
+		else if (m11 > m22)
+		{
+			float r = (float)sqrt(1 + m11 - m00 - m22) * 2;
+			q = Quaternion((m01 + m10) / r, r / 4, (m12 + m21) / r, (m02 - m20) / r);
+		}
+		else
+		{
+			float r = (float)sqrt(1 + m22 - m00 - m11) * 2;
+			q = Quaternion((m02 + m20) / r, (m12 + m21) / r, r / 4, (m10 - m01) / r);
+		}
+
+		return (q.Normalised());
+	}
+
+
+	float Dot(const Quaternion& q) const
+	{
+		return (x * q.x + y * q.y + z * q.z + w * q.w);
+	}
+
+
+	Quaternion Normalised(void) const
+	{
+		float length = (float)sqrt(Dot(*this));
+		return (Quaternion(x / length, y / length, z / length, w / length));
+	}
+
+
+	Quaternion operator - (void) const
+	{
+		return (Quaternion(-x, -y, -z, -w));
+	}
+
+
+	// Rotates a vector by this orientation
+	Point<3> Rotate(const Point<3>& v) const
+	{
+		// v + 2w(q x v) + 2q x (q x v), with q the vector part
+		Point<3> q;
+		q.values[0] = x;
+		q.values[1] = y;
+		q.values[2] = z;
+
+		Point<3> t = Cross(q, v) * 2;
+		return (v + t * w + Cross(q, t));
+	}
+
+
+	// The three axes this orientation takes the x, y and z axes onto
+	void GetAxes(Point<3>& ax, Point<3>& ay, Point<3>& az) const
+	{
+		ax.values[0] = 1 - 2 * (y * y + z * z);
+		ax.values[1] = 2 * (x * y + w * z);
+		ax.values[2] = 2 * (x * z - w * y);
+
+		ay.values[0] = 2 * (x * y - w * z);
+		ay.values[1] = 1 - 2 * (x * x + z * z);
+		ay.values[2] = 2 * (y * z + w * x);
+
+		az.values[0] = 2 * (x * z + w * y);
+		az.values[1] = 2 * (y * z - w * x);
+		az.values[2] = 1 - 2 * (x * x + y * y);
+	}
+
+
+	float	x, y, z;
+	float	w;
+};
+
+
+// Spherical linear interpolation, turning at a constant rate from a to b along the shortest
+// way round
+inline Quaternion Slerp(const Quaternion& a, const Quaternion& b, const float t)
+{
+	// Either of q and -q give the same orientation, pick the one nearest a
+	float cos_angle = a.Dot(b);
+	Quaternion c = cos_angle < 0 ? -b : b;
+	if (cos_angle < 0)
+		cos_angle = -cos_angle;
+
+	float wa, wb;
+	if (cos_angle > 0.9995f)
+	{
+		// Nearly the same, where lerping is just as good and the sine below is no good
+		wa = 1 - t;
+		wb = t;
+	}
+	else
+	{
+		float angle = (float)acos(cos_angle);
+		float sin_angle = (float)sin(angle);
+		wa = (float)sin((1 - t) * angle) / sin_angle;
+		wb = (float)sin(t * angle) / sin_angle;
+	}
+
+	Quaternion q(a.x * wa + c.x * wb, a.y * wa + c.y * wb, a.z * wa + c.z * wb, a.w * wa + c.w * wb);
+	return (q.Normalised());
+}
+
+
+#endif	/* _INCLUDED_QUATERNION_H */
@@ -1,178 +1,332 @@
 
 #include "SDLAFont.h"
-#include "SDLApp.h"			// For oGL
+#include "SDLARenderer.h"
+#include "SDLAFontFormat.h"
+#include "SDLAMappedFile.h"
 #include <cstdio>
+#include <cstring>
 
 
-cSDLAFont::cSDLAFont(const char* filename, const int window_width, const int window_height) :
+cSDLAFont::cSDLAFont(const char* filename, const int window_width, const int window_height, cSDLARenderer* renderer) :
 
+	m_IsBatching(false),
+	m_Renderer(renderer),
 	m_WindowWidth(window_width),
 	m_WindowHeight(window_height)
 
 {
 	int	i;
 
-	// Open the font database
-	FILE* fp = fopen(filename, "rb");
-	if (fp == 0)
-		throw cException("Couldn't open file %s", filename);
+	// Map the font database, the pages are uploaded straight from it
+	cSDLAMappedFile file(filename);
+	const unsigned char* data = file.GetData();
 
-	// Read the tpage count
-	fread(&m_NbTPages, 1, sizeof(int), fp);
+	if (file.GetSize() >= (int)sizeof(FontDBHeader) && memcmp(data, FONTDB_MAGIC, 4) == 0)
+		LoadV2(data, file.GetSize());
+	else
+		LoadV1(data, file.GetSize());
 
-	// Generate the texture IDs
-	m_Pages = new unsigned int[m_NbTPages];
-	glGenTextures(m_NbTPages, m_Pages);
+	// Determine the width of the space as half the widest character
+	Char& space = m_Chars[m_NbChars];
+	memset(&space, 0, sizeof(space));
+	for (i = 0; i < m_NbChars; i++)
+		if (m_Chars[i].advance > space.advance)
+			space.advance = m_Chars[i].advance;
+
+	space.advance /= 2;
+
+	// Build the lookup table once, defaulting to the space character
+	for (i = 0; i < 256; i++)
+		m_CharTable[i] = &m_Chars[m_NbChars];
+	for (i = 0; i < m_NbChars; i++)
+		m_CharTable[m_Chars[i].code & 255] = &m_Chars[i];
+
+	// Empty quad lists for each page
+	m_Batches = new PageBatch[m_NbTPages];
+	memset(m_Batches, 0, m_NbTPages * sizeof(PageBatch));
+}
+
+
+void cSDLAFont::LoadV1(const unsigned char* data, const int size)
+{
+	int	i;
+
+	// Make sure the pages and the whole character list are there, and the characters are
+	// on the pages, before using any of it
+	if (!FontDBCheckV1(data, size, m_NbTPages, m_NbChars))
+		throw cException("Font database is corrupt");
+
+	const unsigned char* pages = data + sizeof(int);
+	const FontDBCharV1* chars = (const FontDBCharV1*)(pages + m_NbTPages * FONTDB_V1_PAGE_SIZE + sizeof(int));
 
-	// Allocate a temporary texture page in system memory
-	unsigned char* buffer_ptr = new unsigned char[256 * 256 * 3];
+	// Texture co-ordinates have always been scaled like this in these files
+	m_TexelU = 1.0f / 255.0f;
+	m_TexelV = 1.0f / 255.0f;
+
+	CreatePages();
 
 	for (i = 0; i < m_NbTPages; i++)
+		UploadPage(i, 256, 256, GL_RGB, pages + i * FONTDB_V1_PAGE_SIZE);
+
+	// Allocate the character list (plus a space character)
+	m_Chars = new Char[m_NbChars + 1];
+
+	// Convert the character list, all characters fill a full height cell
+	for (i = 0; i < m_NbChars; i++)
 	{
-		// Bind to the current texture
-		glBindTexture(GL_TEXTURE_2D, m_Pages[i]);
-
-		// Read the current page from file
-		fread(buffer_ptr, 1, 256 * 256 * 3, fp);
-
-		// Upload it to video memory
-		glTexImage2D(GL_TEXTURE_2D,
-			0,
-			3,
-			256,
-			256,
-			0,
-			GL_RGB,
-			GL_UNSIGNED_BYTE,
-			buffer_ptr);
-
-		// Setup texture states
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		Char& c = m_Chars[i];
+		c.code = chars[i].code;
+		c.tpage = chars[i].tpage;
+		c.x = chars[i].x;
+		c.y = chars[i].y;
+		c.w = chars[i].w;
+		c.h = FONTDB_CELL_HEIGHT;
+		c.x_offset = 0;
+		c.y_offset = 0;
+		c.advance = chars[i].w;
 	}
+}
+
+
+void cSDLAFont::LoadV2(const unsigned char* data, const int size)
+{
+	int	i;
+
+	const FontDBHeader* header = (const FontDBHeader*)data;
+
+	if (header->version != FONTDB_VERSION)
+		throw cException("Unsupported font database version %d", header->version);
+
+	// Make sure everything the header points to is in the file, and every glyph is on a
+	// page and within it
+	if (!FontDBCheckV2(data, size))
+		throw cException("Font database is corrupt");
 
-	// Release tpage
-	delete [] buffer_ptr;
+	int page_size = header->page_width * header->page_height;
+	const FontDBChar* chars = (const FontDBChar*)(data + header->chars_offset);
+
+	m_NbTPages = header->nb_pages;
+	m_TexelU = 1.0f / (float)header->page_width;
+	m_TexelV = 1.0f / (float)header->page_height;
+
+	CreatePages();
+
+	// Coverage goes straight from the mapping to video memory
+	const unsigned char* pages = data + header->pages_offset;
+	for (i = 0; i < m_NbTPages; i++)
+		UploadPage(i, header->page_width, header->page_height, GL_LUMINANCE, pages + i * page_size);
 
 	// Allocate the character list (plus a space character)
-	fread(&m_NbChars, 1, sizeof(int), fp);
+	m_NbChars = header->nb_chars;
 	m_Chars = new Char[m_NbChars + 1];
 
-	// Read in the character list
-	fread(m_Chars, 1, m_NbChars * sizeof(Char), fp);
-
-	// Determine the width of the as the widest character
-	m_Chars[m_NbChars].w = 0;
 	for (i = 0; i < m_NbChars; i++)
-		if (m_Chars[i].w > m_Chars[m_NbChars].w)
-			m_Chars[m_NbChars].w = m_Chars[i].w;
+	{
+		Char& c = m_Chars[i];
+		c.code = chars[i].code;
+		c.tpage = chars[i].tpage;
+		c.x = chars[i].x;
+		c.y = chars[i].y;
+		c.w = chars[i].w;
+		c.h = chars[i].h;
+		c.x_offset = chars[i].x_offset;
+		c.y_offset = chars[i].y_offset;
+		c.advance = chars[i].advance;
+	}
+}
 
-	m_Chars[m_NbChars].w /= 2;
 
-	// Over it
-	fclose(fp);
+void cSDLAFont::CreatePages(void)
+{
+	// Generate the texture IDs
+	m_Pages = new unsigned int[m_NbTPages];
+	m_Renderer->GenTextures(m_NbTPages, m_Pages);
+}
+
+
+void cSDLAFont::UploadPage(const int index, const int width, const int height, const int format, const unsigned char* data)
+{
+	// Bind to the current texture
+	m_Renderer->BindTexture(GL_TEXTURE_2D, m_Pages[index]);
+
+	// Rows are tightly packed in both formats
+	m_Renderer->PixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	// Upload it to video memory
+	m_Renderer->TexImage2D(GL_TEXTURE_2D,
+		0,
+		format == GL_RGB ? 3 : GL_LUMINANCE,
+		width,
+		height,
+		0,
+		format,
+		GL_UNSIGNED_BYTE,
+		data);
+
+	// Setup texture states
+	m_Renderer->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	m_Renderer->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	m_Renderer->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	m_Renderer->TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 }
 
 
 cSDLAFont::~cSDLAFont(void)
 {
+	for (int i = 0; i < m_NbTPages; i++)
+		delete [] m_Batches[i].verts;
+	delete [] m_Batches;
+
 	delete [] m_Chars;
-	glDeleteTextures(m_NbTPages, m_Pages);
+	m_Renderer->DeleteTextures(m_NbTPages, m_Pages);
 	delete [] m_Pages;
 }
 
 
 void cSDLAFont::WriteText(const char* text_ptr, const float x, const float y, const float scale)
 {
-	int		i, j;
-	float	xpos;
+	Layout(text_ptr, x, y, scale, m_Batches);
+
+	// Draw straight away if the text isn't being collected
+	if (m_IsBatching == false)
+		Flush();
+}
+
+
+float cSDLAFont::Layout(const char* text_ptr, const float x, const float y, const float scale, PageBatch* batches) const
+{
+	// Start of the line
+	float xpos = 0;
+
+	for (const unsigned char* c = (const unsigned char*)text_ptr; *c; c++)
+	{
+		const Char* char_ptr = m_CharTable[*c];
+
+		// Step over this character once it's been written
+		float advance = (char_ptr->advance + 2) * scale;
+
+		// Ignore space
+		if (char_ptr == &m_Chars[m_NbChars])
+		{
+			xpos += advance;
+			continue;
+		}
 
-	// Table containing pointers to each character
-	Char*	char_table[512];
+		// Character cells are measured in pixels across the window
+		float k = scale / (float)m_WindowWidth;
+
+		// Figure out quad dimensions, placing the glyph down from the top of its cell
+		float x0 = x + xpos / (float)m_WindowWidth + char_ptr->x_offset * k;
+		float x1 = x0 + char_ptr->w * k;
+		float y1 = y + (FONTDB_CELL_HEIGHT - char_ptr->y_offset) * k;
+		float y0 = y1 - char_ptr->h * k;
+
+		// Figure out texture dimensions
+		float u0 = (float)char_ptr->x * m_TexelU;
+		float u1 = u0 + (float)char_ptr->w * m_TexelU;
+		float v1 = (float)char_ptr->y * m_TexelV;
+		float v0 = v1 + (float)char_ptr->h * m_TexelV;
+
+		// Add the quad to the list for its page
+		float* v = Reserve(batches[char_ptr->tpage], 4);
+		v[0] = x0;	v[1] = y0;	v[2] = u0;	v[3] = v0;
+		v[4] = x0;	v[5] = y1;	v[6] = u0;	v[7] = v1;
+		v[8] = x1;	v[9] = y1;	v[10] = u1;	v[11] = v1;
+		v[12] = x1;	v[13] = y0;	v[14] = u1;	v[15] = v0;
+
+		xpos += advance;
+	}
+
+	return (xpos / (float)m_WindowWidth);
+}
 
-	for (i = 0; i < 512; i++)
-		char_table[i] = &m_Chars[m_NbChars];
 
-	for (i = 0; text_ptr[i]; i++)
+float* cSDLAFont::Reserve(PageBatch& batch, const int nb_verts)
+{
+	// Grow the quad list by doubling
+	if (batch.nb_verts + nb_verts > batch.max_verts)
 	{
-		// Search for the current character in the font
-		for (j = 0; j < m_NbChars; j++)
-			if (text_ptr[i] == m_Chars[j].code)
-				break;
+		int new_max = batch.max_verts ? batch.max_verts : 256;
+		while (new_max < batch.nb_verts + nb_verts)
+			new_max *= 2;
 
-		// Assign the table pointer
-		char_table[i] = &m_Chars[j];
+		float* new_verts = new float[new_max * 4];
+		if (batch.verts)
+			memcpy(new_verts, batch.verts, batch.nb_verts * 4 * sizeof(float));
+
+		delete [] batch.verts;
+		batch.verts = new_verts;
+		batch.max_verts = new_max;
 	}
 
+	float* v = &batch.verts[batch.nb_verts * 4];
+	batch.nb_verts += nb_verts;
+	return (v);
+}
+
+
+void cSDLAFont::BeginBatch(void)
+{
+	m_IsBatching = true;
+}
+
+
+void cSDLAFont::EndBatch(void)
+{
+	m_IsBatching = false;
+	Flush();
+}
+
+
+void cSDLAFont::Flush(void)
+{
 	// Setup a flat projection matrix
-	glMatrixMode(GL_PROJECTION);
-	glPushMatrix();
-	glLoadIdentity();
-	glScalef((float)m_WindowHeight / (float)m_WindowWidth, 1, 1);
+	m_Renderer->MatrixMode(GL_PROJECTION);
+	m_Renderer->PushMatrix();
+	m_Renderer->LoadIdentity();
+	m_Renderer->Scalef((float)m_WindowHeight / (float)m_WindowWidth, 1, 1);
 
 	// No object-space
-	glMatrixMode(GL_MODELVIEW);
-	glPushMatrix();
-	glLoadIdentity();
+	m_Renderer->MatrixMode(GL_MODELVIEW);
+	m_Renderer->PushMatrix();
+	m_Renderer->LoadIdentity();
 
 	// Additive blending
-	glBlendFunc(GL_ONE, GL_ONE);
+	m_Renderer->BlendFunc(GL_ONE, GL_ONE);
 
-	glColor3f(1, 1, 1);
+	m_Renderer->Color3f(1, 1, 1);
 
-	for (i = 0; i < m_NbTPages; i++)
+	m_Renderer->EnableClientState(GL_VERTEX_ARRAY);
+	m_Renderer->EnableClientState(GL_TEXTURE_COORD_ARRAY);
+
+	for (int i = 0; i < m_NbTPages; i++)
 	{
+		PageBatch& batch = m_Batches[i];
+		if (batch.nb_verts == 0)
+			continue;
+
 		// Set the texture for this page
-		glBindTexture(GL_TEXTURE_2D, m_Pages[i]);
+		m_Renderer->BindTexture(GL_TEXTURE_2D, m_Pages[i]);
 
-		// Start of the line
-		xpos = 0;
+		// All quads on this page in one go
+		m_Renderer->VertexPointer(2, GL_FLOAT, 4 * sizeof(float), batch.verts);
+		m_Renderer->TexCoordPointer(2, GL_FLOAT, 4 * sizeof(float), batch.verts + 2);
+		m_Renderer->DrawArrays(GL_QUADS, 0, batch.nb_verts);
 
-		for (j = 0; text_ptr[j]; xpos += (char_table[j]->w + 2) * scale, j++)
-		{
-			// Ignore space
-			if (char_table[j] == &m_Chars[m_NbChars])
-				continue;
-
-			// Ignore characters not on this texture page
-			if (char_table[j]->tpage != i)
-				continue;
-
-			// Figure out quad dimensions
-			float x0 = x + xpos / (float)m_WindowWidth;
-			float x1 = x0 + ((float)char_table[j]->w / (float)m_WindowWidth) * scale;
-			float y0 = y;
-			float y1 = y0 + (31.0f / (float)m_WindowWidth) * scale;
-
-			// Figure out texture dimensions
-			float u0 = (float)char_table[j]->x / 255.0f;
-			float u1 = u0 + (float)char_table[j]->w / 255.0f;
-			float v1 = (float)char_table[j]->y / 255.0f;
-			float v0 = v1 + 31.0f / 255.0f;
-
-			glBegin(GL_TRIANGLE_STRIP);
-			glTexCoord2f(u0, v0);
-			glVertex3f(x0, y0, 1);
-			glTexCoord2f(u0, v1);
-			glVertex3f(x0, y1, 1);
-			glTexCoord2f(u1, v0);
-			glVertex3f(x1, y0, 1);
-			glTexCoord2f(u1, v1);
-			glVertex3f(x1, y1, 1);
-			glEnd();
-		}
+		batch.nb_verts = 0;
 	}
 
+	m_Renderer->DisableClientState(GL_TEXTURE_COORD_ARRAY);
+	m_Renderer->DisableClientState(GL_VERTEX_ARRAY);
+
 	// Restore old matrices
-	glPopMatrix();
-	glMatrixMode(GL_PROJECTION);
-	glPopMatrix();
+	m_Renderer->PopMatrix();
+	m_Renderer->MatrixMode(GL_PROJECTION);
+	m_Renderer->PopMatrix();
 
 	// Take a guess at what the user's old blending mode was (no blending)
-	glBlendFunc(GL_ONE, GL_ZERO);
-	glBindTexture(GL_TEXTURE_2D, 0);
+	m_Renderer->BlendFunc(GL_ONE, GL_ZERO);
+	m_Renderer->BindTexture(GL_TEXTURE_2D, 0);
 }
 
 
@@ -180,3 +334,81 @@ float cSDLAFont::GetLineHeight(void) const
 {
 	return (32.0f / m_WindowHeight);
 }
+
+
+cSDLAText::cSDLAText(cSDLAFont* font) :
+
+	m_Font(font),
+	m_Text(0),
+	m_TextSize(0),
+	m_X(0),
+	m_Y(0),
+	m_Scale(0),
+	m_Width(0)
+
+{
+	// Empty quad lists for each page
+	m_Quads = new cSDLAFont::PageBatch[font->m_NbTPages];
+	memset(m_Quads, 0, font->m_NbTPages * sizeof(cSDLAFont::PageBatch));
+}
+
+
+cSDLAText::~cSDLAText(void)
+{
+	for (int i = 0; i < m_Font->m_NbTPages; i++)
+		delete [] m_Quads[i].verts;
+	delete [] m_Quads;
+
+	delete [] m_Text;
+}
+
+
+void cSDLAText::Set(const char* text_ptr, const float x, const float y, const float scale)
+{
+	// Nothing to do if it's all the same as last time
+	if (m_Text && x == m_X && y == m_Y && scale == m_Scale && strcmp(text_ptr, m_Text) == 0)
+		return;
+
+	// Keep a copy of the text to compare against
+	int size = strlen(text_ptr) + 1;
+	if (size > m_TextSize)
+	{
+		delete [] m_Text;
+		m_Text = new char[size];
+		m_TextSize = size;
+	}
+	memcpy(m_Text, text_ptr, size);
+
+	m_X = x;
+	m_Y = y;
+	m_Scale = scale;
+
+	// Throw away the old quads and lay out the new ones
+	for (int i = 0; i < m_Font->m_NbTPages; i++)
+		m_Quads[i].nb_verts = 0;
+	m_Width = m_Font->Layout(text_ptr, x, y, scale, m_Quads);
+}
+
+
+void cSDLAText::Draw(void) const
+{
+	// Copy the quads straight into the font's page lists
+	for (int i = 0; i < m_Font->m_NbTPages; i++)
+	{
+		if (m_Quads[i].nb_verts == 0)
+			continue;
+
+		float* v = cSDLAFont::Reserve(m_Font->m_Batches[i], m_Quads[i].nb_verts);
+		memcpy(v, m_Quads[i].verts, m_Quads[i].nb_verts * 4 * sizeof(float));
+	}
+
+	// Draw straight away if the text isn't being collected
+	if (m_Font->m_IsBatching == false)
+		m_Font->Flush();
+}
+
+
+float cSDLAText::GetWidth(void) const
+{
+	return (m_Width);
+}
@@ -3,46 +3,138 @@
 #define	_INCLUDED_SDLAFONT_H
 
 
+class cSDLAText;
+class cSDLARenderer;
+
+
 class cSDLAFont
 {
+	friend class cSDLAText;
+
 public:
-	cSDLAFont(const char* filename, const int window_width, const int window_height);
+	cSDLAFont(const char* filename, const int window_width, const int window_height, cSDLARenderer* renderer);
 	~cSDLAFont(void);
 
 	void	WriteText(const char* text_ptr, const float x, const float y, const float scale);
 
 	float	GetLineHeight(void) const;
 
+	// Text written between these calls is collected and drawn all at once with a single
+	// draw per texture page, rather than once per WriteText call
+	void	BeginBatch(void);
+	void	EndBatch(void);
+
 private:
 	struct Char
 	{
 		// ASCII code
 		int		code;
 
-		// Position of this character in the tpage
+		// Texture page the character is on
+		int		tpage;
+
+		// Rectangle of the glyph in the tpage
 		int		x, y;
+		int		w, h;
 
-		// Width of the character
-		int		w;
+		// Offset of the glyph from the left and top of the character cell
+		int		x_offset, y_offset;
 
-		// Texture page the character is on
-		int		tpage;
+		// Distance to move along the line after the character
+		int		advance;
 	};
 
+	// Read either version of the font database from memory
+	void	LoadV1(const unsigned char* data, const int size);
+	void	LoadV2(const unsigned char* data, const int size);
+
+	// Create the texture pages and fill them in
+	void	CreatePages(void);
+	void	UploadPage(const int index, const int width, const int height, const int format, const unsigned char* data);
+
+	struct PageBatch
+	{
+		// Vertices used and allocated
+		int		nb_verts;
+		int		max_verts;
+
+		// Interleaved (x, y, u, v) quad vertices
+		float*	verts;
+	};
+
+	// Add the quads for a line of text to a list of page batches, returning its width
+	float	Layout(const char* text_ptr, const float x, const float y, const float scale, PageBatch* batches) const;
+
+	// Make space for more vertices in a batch, returning where they should be written
+	static float*	Reserve(PageBatch& batch, const int nb_verts);
+
+	// Draw all collected quads and empty the page batches
+	void	Flush(void);
+
 	// Number of texture pages used for this font
 	int		m_NbTPages;
 
 	// OpenGL texture ID per page
 	unsigned int*	m_Pages;
 
+	// Size of a texel in texture co-ordinates
+	float	m_TexelU;
+	float	m_TexelV;
+
 	// List of characters supported by the font
 	int		m_NbChars;
 	Char*	m_Chars;
 
+	// Character code lookup, unknown characters point to the space
+	Char*	m_CharTable[256];
+
+	// Quads waiting to be drawn, one list per texture page
+	PageBatch*	m_Batches;
+
+	// Is the user collecting text for a later draw?
+	bool	m_IsBatching;
+
+	// Everything is drawn through this
+	cSDLARenderer*	m_Renderer;
+
 	// Dimensions of the window the text is being drawn in
 	int		m_WindowWidth;
 	int		m_WindowHeight;
 };
 
 
+// A line of text that keeps its laid out quads between frames and only lays them out
+// again when the text or its position changes. Drawing is then a copy of the quads into
+// the font's batches.
+class cSDLAText
+{
+public:
+	cSDLAText(cSDLAFont* font);
+	~cSDLAText(void);
+
+	void	Set(const char* text_ptr, const float x, const float y, const float scale);
+
+	void	Draw(void) const;
+
+	// Width of the text on screen
+	float	GetWidth(void) const;
+
+private:
+	// Font the text is laid out with
+	cSDLAFont*	m_Font;
+
+	// Copy of the text and the space allocated for it
+	char*	m_Text;
+	int		m_TextSize;
+
+	// Placement of the text
+	float	m_X, m_Y, m_Scale;
+
+	float	m_Width;
+
+	// Laid out quads, one list per texture page of the font
+	cSDLAFont::PageBatch*	m_Quads;
+};
+
+
 #endif	/* _INCLUDED_SDLAFONT_H */
\ No newline at end of file
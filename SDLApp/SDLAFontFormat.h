@@ -0,0 +1,168 @@
+#ifndef	_INCLUDED_SDLAFONTFORMAT_H
+#define	_INCLUDED_SDLAFONTFORMAT_H
+
+
+#include <cstring>
+
+
+// On-disk layout of a font database.
+//
+// Version 1 files (the original MakeFont output) are:
+//
+//		int				nb_tpages
+//		unsigned char	rgb[nb_tpages][256 * 256 * 3]
+//		int				nb_chars
+//		FontDBCharV1	chars[nb_chars]
+//
+// Version 2 files store 8-bit coverage with glyphs packed into as few pages as possible.
+// Everything is found through offsets in the header so that the file can be mapped into
+// memory and the pages uploaded straight from the mapping:
+//
+//		FontDBHeader	header
+//		FontDBChar		chars[header.nb_chars]		(at header.chars_offset)
+//		unsigned char	coverage[header.nb_pages][header.page_width * header.page_height]
+//														(at header.pages_offset)
+
+
+// First four bytes of a version 2 file, never a sensible page count for version 1
+#define	FONTDB_MAGIC	"FDB2"
+#define	FONTDB_VERSION	2
+
+
+// Pages are aligned to this in version 2 files
+#define	FONTDB_PAGE_ALIGN	16
+
+
+// Height of the character cell that glyphs are positioned in, and of every version 1 glyph
+#define	FONTDB_CELL_HEIGHT	31
+
+
+// Each version 1 page is a 256x256 RGB image
+#define	FONTDB_V1_PAGE_SIZE	(256 * 256 * 3)
+
+
+struct FontDBCharV1
+{
+	// ASCII code
+	int		code;
+
+	// Position of this character in the tpage
+	int		x, y;
+
+	// Width of the character, height is 31
+	int		w;
+
+	// Texture page the character is on
+	int		tpage;
+};
+
+
+struct FontDBHeader
+{
+	// FONTDB_MAGIC and FONTDB_VERSION
+	char	magic[4];
+	int		version;
+
+	// Dimensions of each page, powers of two
+	int		page_width;
+	int		page_height;
+	int		nb_pages;
+
+	int		nb_chars;
+
+	// Byte offsets from the start of the file
+	int		chars_offset;
+	int		pages_offset;
+};
+
+
+struct FontDBChar
+{
+	// ASCII code
+	int		code;
+
+	// Texture page the character is on
+	int		tpage;
+
+	// Rectangle of the glyph in the tpage
+	int		x, y;
+	int		w, h;
+
+	// Offset of the glyph from the left and top of the character cell
+	int		x_offset, y_offset;
+
+	// Distance to move along the line after the character
+	int		advance;
+};
+
+
+// Does a glyph's rectangle lie within one of the font's pages?
+inline bool FontDBIsInPage(const int tpage, const int x, const int y, const int w, const int h, const int nb_pages, const int page_width, const int page_height)
+{
+	return (tpage >= 0 && tpage < nb_pages &&
+		x >= 0 && w >= 0 && w <= page_width && x <= page_width - w &&
+		y >= 0 && h >= 0 && h <= page_height && y <= page_height - h);
+}
+
+
+// Checks that a version 1 file holds all the pages and characters it says it does, with
+// every character on one of the pages, and returns their counts. Nothing should be taken
+// from the file unless this passes. Sizes are compared by dividing the space left rather
+// than multiplying, so that a huge count can't overflow.
+inline bool FontDBCheckV1(const unsigned char* data, const int size, int& nb_pages, int& nb_chars)
+{
+	// Page count, the pages and then the character count
+	if (size < (int)sizeof(int) * 2)
+		return (false);
+	memcpy(&nb_pages, data, sizeof(int));
+	if (nb_pages <= 0 || nb_pages > (size - (int)sizeof(int) * 2) / FONTDB_V1_PAGE_SIZE)
+		return (false);
+
+	data += sizeof(int) + nb_pages * FONTDB_V1_PAGE_SIZE;
+	memcpy(&nb_chars, data, sizeof(int));
+	if (nb_chars < 0 || nb_chars > (size - (int)sizeof(int) * 2 - nb_pages * FONTDB_V1_PAGE_SIZE) / (int)sizeof(FontDBCharV1))
+		return (false);
+
+	const FontDBCharV1* chars = (const FontDBCharV1*)(data + sizeof(int));
+	for (int i = 0; i < nb_chars; i++)
+	{
+		if (!FontDBIsInPage(chars[i].tpage, chars[i].x, chars[i].y, chars[i].w, FONTDB_CELL_HEIGHT, nb_pages, 256, 256))
+			return (false);
+	}
+
+	return (true);
+}
+
+
+// The same for a version 2 file, checking that everything the header points to is in the
+// file and that every glyph is within its page. The version isn't checked.
+inline bool FontDBCheckV2(const unsigned char* data, const int size)
+{
+	if (size < (int)sizeof(FontDBHeader))
+		return (false);
+
+	const FontDBHeader* header = (const FontDBHeader*)data;
+	if (header->page_width <= 0 || header->page_height <= 0 ||
+		header->nb_pages <= 0 || header->nb_chars < 0 ||
+		header->page_width > size / header->page_height)
+		return (false);
+
+	int page_size = header->page_width * header->page_height;
+	if (header->chars_offset < (int)sizeof(FontDBHeader) || header->chars_offset > size ||
+		header->nb_chars > (size - header->chars_offset) / (int)sizeof(FontDBChar) ||
+		header->pages_offset < (int)sizeof(FontDBHeader) || header->pages_offset > size ||
+		header->nb_pages > (size - header->pages_offset) / page_size)
+		return (false);
+
+	const FontDBChar* chars = (const FontDBChar*)(data + header->chars_offset);
+	for (int i = 0; i < header->nb_chars; i++)
+	{
+		if (!FontDBIsInPage(chars[i].tpage, chars[i].x, chars[i].y, chars[i].w, chars[i].h, header->nb_pages, header->page_width, header->page_height))
+			return (false);
+	}
+
+	return (true);
+}
+
+
+#endif	/* _INCLUDED_SDLAFONTFORMAT_H */
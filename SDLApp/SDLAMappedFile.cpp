@@ -0,0 +1,100 @@
+#include "SDLAMappedFile.h"
+#include "Exception.h"
+
+#ifdef	WIN32
+	#define	WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+
+cSDLAMappedFile::cSDLAMappedFile(const char* filename) :
+
+	m_Data(0),
+	m_Size(0),
+	m_File(0),
+	m_Mapping(0)
+
+{
+#ifdef	WIN32
+
+	// Open the file for reading
+	HANDLE file = CreateFile(filename, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+	if (file == INVALID_HANDLE_VALUE)
+		throw cException("Couldn't open file %s", filename);
+
+	m_File = file;
+	m_Size = GetFileSize(file, 0);
+
+	// Map the whole thing
+	HANDLE mapping = CreateFileMapping(file, 0, PAGE_READONLY, 0, 0, 0);
+	if (mapping == 0)
+	{
+		CloseHandle(file);
+		throw cException("Couldn't map file %s", filename);
+	}
+
+	m_Mapping = mapping;
+	m_Data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+	if (m_Data == 0)
+	{
+		CloseHandle(mapping);
+		CloseHandle(file);
+		throw cException("Couldn't map file %s", filename);
+	}
+
+#else
+
+	// Open the file for reading
+	int fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		throw cException("Couldn't open file %s", filename);
+
+	struct stat st;
+	fstat(fd, &st);
+	m_Size = (int)st.st_size;
+
+	// Map the whole thing, the descriptor isn't needed after that
+	void* data = mmap(0, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (data == MAP_FAILED)
+		throw cException("Couldn't map file %s", filename);
+
+	m_Data = (const unsigned char*)data;
+
+#endif
+}
+
+
+cSDLAMappedFile::~cSDLAMappedFile(void)
+{
+#ifdef	WIN32
+
+	UnmapViewOfFile(m_Data);
+	CloseHandle(m_Mapping);
+	CloseHandle(m_File);
+
+#else
+
+	munmap((void*)m_Data, m_Size);
+
+#endif
+}
+
+
+const unsigned char* cSDLAMappedFile::GetData(void) const
+{
+	return (m_Data);
+}
+
+
+int cSDLAMappedFile::GetSize(void) const
+{
+	return (m_Size);
+}
@@ -0,0 +1,263 @@
+#include "SDLAProfiler.h"
+#include "SDLAFont.h"
+#include "SDLATimer.h"
+#include "Exception.h"
+#include <cstring>
+
+
+// Width of each histogram bucket in seconds, giving a range of 50ms
+static const double BUCKET_WIDTH = 0.00025;
+
+// Weight of the latest frame in the smoothed section times
+static const double SMOOTHING = 0.05;
+
+
+cSDLAProfiler::cSDLAProfiler(void) :
+
+	m_NbSections(0),
+	m_Depth(0),
+	m_FrameStart(0),
+	m_FrameTime(0),
+	m_NbHistory(0),
+	m_NextHistory(0),
+	m_TraceFile(0),
+	m_TraceStart(0),
+	m_IsFirstEvent(true),
+	m_NbEvents(0)
+
+{
+	memset(m_Buckets, 0, sizeof(m_Buckets));
+}
+
+
+cSDLAProfiler::~cSDLAProfiler(void)
+{
+	StopTrace();
+}
+
+
+void cSDLAProfiler::BeginFrame(void)
+{
+	m_FrameStart = SDLAGetTime();
+	m_Depth = 0;
+}
+
+
+void cSDLAProfiler::EndFrame(void)
+{
+	m_FrameTime = SDLAGetTime() - m_FrameStart;
+
+	// Drop the oldest frame from the histogram once it's full
+	if (m_NbHistory == NB_HISTORY)
+		m_Buckets[m_History[m_NextHistory]]--;
+	else
+		m_NbHistory++;
+
+	// Add the new frame, clamping long ones to the last bucket
+	int bucket = (int)(m_FrameTime / BUCKET_WIDTH);
+	if (bucket >= NB_BUCKETS)
+		bucket = NB_BUCKETS - 1;
+	m_Buckets[bucket]++;
+	m_History[m_NextHistory] = bucket;
+	m_NextHistory = (m_NextHistory + 1) % NB_HISTORY;
+
+	// Fold this frame's section totals into the averages
+	for (int i = 0; i < m_NbSections; i++)
+	{
+		Section& section = m_Sections[i];
+		section.average += (section.frame_total - section.average) * SMOOTHING;
+		section.frame_total = 0;
+	}
+
+	if (m_TraceFile)
+	{
+		// The frame encloses all its sections
+		WriteTraceEvent("Frame", m_FrameStart, m_FrameTime);
+		for (int i = 0; i < m_NbEvents; i++)
+			WriteTraceEvent(m_Events[i].name, m_Events[i].start, m_Events[i].duration);
+	}
+
+	m_NbEvents = 0;
+}
+
+
+void cSDLAProfiler::BeginSection(const char* name)
+{
+	// Keep counting past the maximum depth so that begin/end still match up
+	if (m_Depth < MAX_DEPTH)
+	{
+		m_Stack[m_Depth].index = FindSection(name);
+		m_Stack[m_Depth].start = SDLAGetTime();
+	}
+
+	m_Depth++;
+}
+
+
+void cSDLAProfiler::EndSection(void)
+{
+	if (m_Depth == 0)
+		return;
+
+	// Nothing was recorded for sections that were too deep
+	if (--m_Depth >= MAX_DEPTH)
+		return;
+
+	OpenSection& open = m_Stack[m_Depth];
+	if (open.index < 0)
+		return;
+
+	double duration = SDLAGetTime() - open.start;
+	m_Sections[open.index].frame_total += duration;
+
+	// Keep the event for the trace
+	if (m_TraceFile && m_NbEvents < MAX_EVENTS)
+	{
+		Event& event = m_Events[m_NbEvents++];
+		event.name = m_Sections[open.index].name;
+		event.start = open.start;
+		event.duration = duration;
+	}
+}
+
+
+double cSDLAProfiler::GetFrameTime(void) const
+{
+	return (m_FrameTime);
+}
+
+
+double cSDLAProfiler::GetFramePercentile(const float percent) const
+{
+	if (m_NbHistory == 0)
+		return (0);
+
+	// Number of frames that need to be at or under the result
+	int target = (int)(percent * m_NbHistory / 100);
+	if (target < 1)
+		target = 1;
+
+	// Walk up the buckets until enough frames have been seen
+	int count = 0;
+	for (int i = 0; i < NB_BUCKETS; i++)
+	{
+		count += m_Buckets[i];
+		if (count >= target)
+			return ((i + 1) * BUCKET_WIDTH);
+	}
+
+	return (NB_BUCKETS * BUCKET_WIDTH);
+}
+
+
+float cSDLAProfiler::DrawHUD(cSDLAFont* font, const float x, const float y) const
+{
+	Summary summary;
+	GetSummary(summary);
+	return (DrawHUD(summary, font, x, y));
+}
+
+
+void cSDLAProfiler::GetSummary(Summary& summary) const
+{
+	summary.frame_time = m_FrameTime;
+	summary.p50 = GetFramePercentile(50);
+	summary.p95 = GetFramePercentile(95);
+	summary.p99 = GetFramePercentile(99);
+
+	summary.nb_sections = m_NbSections;
+	for (int i = 0; i < m_NbSections; i++)
+	{
+		summary.sections[i].name = m_Sections[i].name;
+		summary.sections[i].depth = m_Sections[i].depth;
+		summary.sections[i].average = m_Sections[i].average;
+	}
+}
+
+
+float cSDLAProfiler::DrawHUD(const Summary& summary, cSDLAFont* font, const float x, const float y)
+{
+	char	buffer[128];
+	float	line_height = font->GetLineHeight();
+	float	ypos = y;
+
+	sprintf(buffer, "Frame %.2fms  p50 %.2f  p95 %.2f  p99 %.2f",
+		summary.frame_time * 1000,
+		summary.p50 * 1000,
+		summary.p95 * 1000,
+		summary.p99 * 1000);
+	font->WriteText(buffer, x, ypos, 1);
+
+	// One line per section, indented by how deep it's nested
+	for (int i = 0; i < summary.nb_sections; i++)
+	{
+		ypos -= line_height;
+		sprintf(buffer, "%*s%s %.3fms", summary.sections[i].depth * 2, "", summary.sections[i].name, summary.sections[i].average * 1000);
+		font->WriteText(buffer, x, ypos, 1);
+	}
+
+	return (ypos - line_height);
+}
+
+
+void cSDLAProfiler::StartTrace(const char* filename)
+{
+	StopTrace();
+
+	if ((m_TraceFile = fopen(filename, "w")) == 0)
+		throw cException("Couldn't open file %s", filename);
+
+	// Timestamps are relative to the start of the trace
+	m_TraceStart = SDLAGetTime();
+	m_IsFirstEvent = true;
+	m_NbEvents = 0;
+
+	fprintf(m_TraceFile, "{\"traceEvents\":[");
+}
+
+
+void cSDLAProfiler::StopTrace(void)
+{
+	if (m_TraceFile == 0)
+		return;
+
+	fprintf(m_TraceFile, "\n]}\n");
+	fclose(m_TraceFile);
+	m_TraceFile = 0;
+}
+
+
+int cSDLAProfiler::FindSection(const char* name)
+{
+	int i;
+
+	// Names are usually literals so compare pointers before strings
+	for (i = 0; i < m_NbSections; i++)
+		if (m_Sections[i].name == name || strcmp(m_Sections[i].name, name) == 0)
+			return (i);
+
+	// No more room, the section goes untimed
+	if (m_NbSections == MAX_SECTIONS)
+		return (-1);
+
+	Section& section = m_Sections[m_NbSections];
+	section.name = name;
+	section.depth = m_Depth;
+	section.frame_total = 0;
+	section.average = 0;
+
+	return (m_NbSections++);
+}
+
+
+void cSDLAProfiler::WriteTraceEvent(const char* name, const double start, const double duration)
+{
+	// Complete events with times in microseconds
+	fprintf(m_TraceFile, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":%.1f,\"dur\":%.1f}",
+		m_IsFirstEvent ? "" : ",",
+		name,
+		(start - m_TraceStart) * 1e6,
+		duration * 1e6);
+
+	m_IsFirstEvent = false;
+}
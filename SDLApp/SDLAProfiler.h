@@ -0,0 +1,170 @@
+#ifndef	_INCLUDED_SDLAPROFILER_H
+#define	_INCLUDED_SDLAPROFILER_H
+
+
+#include <cstdio>
+
+
+class cSDLAFont;
+
+
+// Per-frame instrumentation for SDLApp. The application loop marks the start and end of
+// each frame and user code wraps the parts it's interested in with named sections, which
+// can be nested. Frame times go into a rolling histogram for percentiles, section times
+// are averaged for the on-screen HUD and everything can be written out as a trace file
+// for chrome://tracing.
+class cSDLAProfiler
+{
+public:
+	enum
+	{
+		// Most sections that can be tracked
+		MAX_SECTIONS = 32
+	};
+
+	// Copy of everything the HUD shows. The profiler can only be used from one thread, so
+	// this is what gets handed to any other thread that wants to draw it.
+	struct Summary
+	{
+		// Last frame and the percentiles, in seconds
+		double	frame_time;
+		double	p50, p95, p99;
+
+		int		nb_sections;
+		struct
+		{
+			const char*	name;
+			int			depth;
+			double		average;
+		} sections[MAX_SECTIONS];
+	};
+
+	cSDLAProfiler(void);
+	~cSDLAProfiler(void);
+
+	void	BeginFrame(void);
+	void	EndFrame(void);
+
+	// Section names are expected to be string literals that live as long as the profiler
+	void	BeginSection(const char* name);
+	void	EndSection(void);
+
+	// Duration of the last complete frame in seconds
+	double	GetFrameTime(void) const;
+
+	// Frame time in seconds that the given percentage of recent frames came in under
+	double	GetFramePercentile(const float percent) const;
+
+	// Write the frame percentiles and average section times, starting at the given position.
+	// Returns the position of the line below the last one written.
+	float	DrawHUD(cSDLAFont* font, const float x, const float y) const;
+
+	// The same for a summary taken on another thread
+	void			GetSummary(Summary& summary) const;
+	static float	DrawHUD(const Summary& summary, cSDLAFont* font, const float x, const float y);
+
+	// Record all frames and sections in Chrome trace-event format until stopped
+	void	StartTrace(const char* filename);
+	void	StopTrace(void);
+
+private:
+	enum
+	{
+		// Deepest nesting of sections
+		MAX_DEPTH = 16,
+
+		// Number of frames in the rolling histogram
+		NB_HISTORY = 256,
+
+		// Histogram buckets, the last one collects anything longer
+		NB_BUCKETS = 200,
+
+		// Most section events recorded for the trace in a single frame
+		MAX_EVENTS = 256
+	};
+
+	struct Section
+	{
+		const char*	name;
+
+		// Nesting depth when first seen, used to indent the HUD
+		int		depth;
+
+		// Total time spent in the section this frame
+		double	frame_total;
+
+		// Smoothed time per frame
+		double	average;
+	};
+
+	struct Event
+	{
+		const char*	name;
+
+		// Start and duration in seconds
+		double	start;
+		double	duration;
+	};
+
+	struct OpenSection
+	{
+		int		index;
+		double	start;
+	};
+
+	int		FindSection(const char* name);
+	void	WriteTraceEvent(const char* name, const double start, const double duration);
+
+	// Sections in the order they were first seen
+	int		m_NbSections;
+	Section	m_Sections[MAX_SECTIONS];
+
+	// Sections currently being timed
+	int			m_Depth;
+	OpenSection	m_Stack[MAX_DEPTH];
+
+	// Start of the current frame and duration of the last
+	double	m_FrameStart;
+	double	m_FrameTime;
+
+	// Ring of recent frame bucket indices and the counts in each bucket
+	int		m_History[NB_HISTORY];
+	int		m_NbHistory;
+	int		m_NextHistory;
+	int		m_Buckets[NB_BUCKETS];
+
+	// Trace output and the events waiting to be written this frame
+	FILE*	m_TraceFile;
+	double	m_TraceStart;
+	bool	m_IsFirstEvent;
+	int		m_NbEvents;
+	Event	m_Events[MAX_EVENTS];
+};
+
+
+// Times a section for as long as it's in scope:
+//
+//		{
+//			cSDLAScopedTimer timer(m_Profiler, "Regenerate");
+//			Regenerate();
+//		}
+//
+class cSDLAScopedTimer
+{
+public:
+	cSDLAScopedTimer(cSDLAProfiler* profiler, const char* name) : m_Profiler(profiler)
+	{
+		m_Profiler->BeginSection(name);
+	}
+
+	~cSDLAScopedTimer(void)
+	{
+		m_Profiler->EndSection();
+	}
+
+private:
+	cSDLAProfiler*	m_Profiler;
+};
+
+
+#endif	/* _INCLUDED_SDLAPROFILER_H */
@@ -0,0 +1,192 @@
+#include "SDLARenderer.h"
+
+
+void cSDLAGLRenderer::Enable(const GLenum cap)
+{
+	glEnable(cap);
+}
+
+
+void cSDLAGLRenderer::Disable(const GLenum cap)
+{
+	glDisable(cap);
+}
+
+
+void cSDLAGLRenderer::BlendFunc(const GLenum src, const GLenum dst)
+{
+	glBlendFunc(src, dst);
+}
+
+
+void cSDLAGLRenderer::ClearColor(const float r, const float g, const float b, const float a)
+{
+	glClearColor(r, g, b, a);
+}
+
+
+void cSDLAGLRenderer::Clear(const GLbitfield mask)
+{
+	glClear(mask);
+}
+
+
+void cSDLAGLRenderer::Color3f(const float r, const float g, const float b)
+{
+	glColor3f(r, g, b);
+}
+
+
+void cSDLAGLRenderer::Color3fv(const float* v)
+{
+	glColor3fv(v);
+}
+
+
+void cSDLAGLRenderer::MatrixMode(const GLenum mode)
+{
+	glMatrixMode(mode);
+}
+
+
+void cSDLAGLRenderer::LoadIdentity(void)
+{
+	glLoadIdentity();
+}
+
+
+void cSDLAGLRenderer::PushMatrix(void)
+{
+	glPushMatrix();
+}
+
+
+void cSDLAGLRenderer::PopMatrix(void)
+{
+	glPopMatrix();
+}
+
+
+void cSDLAGLRenderer::Scalef(const float x, const float y, const float z)
+{
+	glScalef(x, y, z);
+}
+
+
+void cSDLAGLRenderer::GenTextures(const int n, unsigned int* textures)
+{
+	glGenTextures(n, textures);
+}
+
+
+void cSDLAGLRenderer::DeleteTextures(const int n, const unsigned int* textures)
+{
+	glDeleteTextures(n, textures);
+}
+
+
+void cSDLAGLRenderer::BindTexture(const GLenum target, const unsigned int texture)
+{
+	glBindTexture(target, texture);
+}
+
+
+void cSDLAGLRenderer::PixelStorei(const GLenum pname, const int param)
+{
+	glPixelStorei(pname, param);
+}
+
+
+void cSDLAGLRenderer::TexImage2D(const GLenum target, const int level, const int internal_format, const int width, const int height, const int border, const GLenum format, const GLenum type, const void* pixels)
+{
+	glTexImage2D(target, level, internal_format, width, height, border, format, type, pixels);
+}
+
+
+void cSDLAGLRenderer::TexParameteri(const GLenum target, const GLenum pname, const int param)
+{
+	glTexParameteri(target, pname, param);
+}
+
+
+void cSDLAGLRenderer::EnableClientState(const GLenum array)
+{
+	glEnableClientState(array);
+}
+
+
+void cSDLAGLRenderer::DisableClientState(const GLenum array)
+{
+	glDisableClientState(array);
+}
+
+
+void cSDLAGLRenderer::VertexPointer(const int size, const GLenum type, const int stride, const void* pointer)
+{
+	glVertexPointer(size, type, stride, pointer);
+}
+
+
+void cSDLAGLRenderer::ColorPointer(const int size, const GLenum type, const int stride, const void* pointer)
+{
+	glColorPointer(size, type, stride, pointer);
+}
+
+
+void cSDLAGLRenderer::TexCoordPointer(const int size, const GLenum type, const int stride, const void* pointer)
+{
+	glTexCoordPointer(size, type, stride, pointer);
+}
+
+
+void cSDLAGLRenderer::DrawArrays(const GLenum mode, const int first, const int count)
+{
+	glDrawArrays(mode, first, count);
+}
+
+
+void cSDLAGLRenderer::Present(void)
+{
+	// Make frame changes visible
+	SDL_GL_SwapBuffers();
+	glFlush();
+}
+
+
+cSDLANullRenderer::cSDLANullRenderer(void) :
+
+	m_NbFrames(0),
+	m_NbDrawCalls(0),
+	m_NbVertices(0),
+	m_NbTextureBinds(0),
+	m_NextTexture(1)
+
+{
+}
+
+
+void cSDLANullRenderer::GenTextures(const int n, unsigned int* textures)
+{
+	// Hand out unique IDs so that users can still tell their textures apart
+	for (int i = 0; i < n; i++)
+		textures[i] = m_NextTexture++;
+}
+
+
+void cSDLANullRenderer::BindTexture(const GLenum, const unsigned int)
+{
+	m_NbTextureBinds++;
+}
+
+
+void cSDLANullRenderer::DrawArrays(const GLenum, const int, const int count)
+{
+	m_NbDrawCalls++;
+	m_NbVertices += count;
+}
+
+
+void cSDLANullRenderer::Present(void)
+{
+	m_NbFrames++;
+}
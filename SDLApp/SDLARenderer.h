@@ -0,0 +1,140 @@
+#ifndef	_INCLUDED_SDLARENDERER_H
+#define	_INCLUDED_SDLARENDERER_H
+
+
+// OpenGL types and constants
+#ifndef	_INCLUDED_SDLAPP_H
+	#include "SDLApp.h"
+#endif
+
+
+// Thin layer over the small subset of OpenGL used by SDLApp and its applications. Each
+// method has the same name and arguments as its gl* equivalent so that the OpenGL
+// implementation can be swapped for one that doesn't need a window or a GPU.
+class cSDLARenderer
+{
+public:
+	virtual ~cSDLARenderer(void) { }
+
+	// Render state
+	virtual void	Enable(const GLenum cap) = 0;
+	virtual void	Disable(const GLenum cap) = 0;
+	virtual void	BlendFunc(const GLenum src, const GLenum dst) = 0;
+	virtual void	ClearColor(const float r, const float g, const float b, const float a) = 0;
+	virtual void	Clear(const GLbitfield mask) = 0;
+	virtual void	Color3f(const float r, const float g, const float b) = 0;
+	virtual void	Color3fv(const float* v) = 0;
+
+	// Matrix stack
+	virtual void	MatrixMode(const GLenum mode) = 0;
+	virtual void	LoadIdentity(void) = 0;
+	virtual void	PushMatrix(void) = 0;
+	virtual void	PopMatrix(void) = 0;
+	virtual void	Scalef(const float x, const float y, const float z) = 0;
+
+	// Textures
+	virtual void	GenTextures(const int n, unsigned int* textures) = 0;
+	virtual void	DeleteTextures(const int n, const unsigned int* textures) = 0;
+	virtual void	BindTexture(const GLenum target, const unsigned int texture) = 0;
+	virtual void	PixelStorei(const GLenum pname, const int param) = 0;
+	virtual void	TexImage2D(const GLenum target, const int level, const int internal_format, const int width, const int height, const int border, const GLenum format, const GLenum type, const void* pixels) = 0;
+	virtual void	TexParameteri(const GLenum target, const GLenum pname, const int param) = 0;
+
+	// Vertex arrays
+	virtual void	EnableClientState(const GLenum array) = 0;
+	virtual void	DisableClientState(const GLenum array) = 0;
+	virtual void	VertexPointer(const int size, const GLenum type, const int stride, const void* pointer) = 0;
+	virtual void	ColorPointer(const int size, const GLenum type, const int stride, const void* pointer) = 0;
+	virtual void	TexCoordPointer(const int size, const GLenum type, const int stride, const void* pointer) = 0;
+	virtual void	DrawArrays(const GLenum mode, const int first, const int count) = 0;
+
+	// Make the frame visible
+	virtual void	Present(void) = 0;
+};
+
+
+// Passes everything straight through to OpenGL
+class cSDLAGLRenderer : public cSDLARenderer
+{
+public:
+	void	Enable(const GLenum cap);
+	void	Disable(const GLenum cap);
+	void	BlendFunc(const GLenum src, const GLenum dst);
+	void	ClearColor(const float r, const float g, const float b, const float a);
+	void	Clear(const GLbitfield mask);
+	void	Color3f(const float r, const float g, const float b);
+	void	Color3fv(const float* v);
+
+	void	MatrixMode(const GLenum mode);
+	void	LoadIdentity(void);
+	void	PushMatrix(void);
+	void	PopMatrix(void);
+	void	Scalef(const float x, const float y, const float z);
+
+	void	GenTextures(const int n, unsigned int* textures);
+	void	DeleteTextures(const int n, const unsigned int* textures);
+	void	BindTexture(const GLenum target, const unsigned int texture);
+	void	PixelStorei(const GLenum pname, const int param);
+	void	TexImage2D(const GLenum target, const int level, const int internal_format, const int width, const int height, const int border, const GLenum format, const GLenum type, const void* pixels);
+	void	TexParameteri(const GLenum target, const GLenum pname, const int param);
+
+	void	EnableClientState(const GLenum array);
+	void	DisableClientState(const GLenum array);
+	void	VertexPointer(const int size, const GLenum type, const int stride, const void* pointer);
+	void	ColorPointer(const int size, const GLenum type, const int stride, const void* pointer);
+	void	TexCoordPointer(const int size, const GLenum type, const int stride, const void* pointer);
+	void	DrawArrays(const GLenum mode, const int first, const int count);
+
+	void	Present(void);
+};
+
+
+// Does no rendering at all, just keeps count of the work it's been given
+class cSDLANullRenderer : public cSDLARenderer
+{
+public:
+	cSDLANullRenderer(void);
+
+	void	Enable(const GLenum) { }
+	void	Disable(const GLenum) { }
+	void	BlendFunc(const GLenum, const GLenum) { }
+	void	ClearColor(const float, const float, const float, const float) { }
+	void	Clear(const GLbitfield) { }
+	void	Color3f(const float, const float, const float) { }
+	void	Color3fv(const float*) { }
+
+	void	MatrixMode(const GLenum) { }
+	void	LoadIdentity(void) { }
+	void	PushMatrix(void) { }
+	void	PopMatrix(void) { }
+	void	Scalef(const float, const float, const float) { }
+
+	void	GenTextures(const int n, unsigned int* textures);
+	void	DeleteTextures(const int, const unsigned int*) { }
+	void	BindTexture(const GLenum target, const unsigned int texture);
+	void	PixelStorei(const GLenum, const int) { }
+	void	TexImage2D(const GLenum, const int, const int, const int, const int, const int, const GLenum, const GLenum, const void*) { }
+	void	TexParameteri(const GLenum, const GLenum, const int) { }
+
+	void	EnableClientState(const GLenum) { }
+	void	DisableClientState(const GLenum) { }
+	void	VertexPointer(const int, const GLenum, const int, const void*) { }
+	void	ColorPointer(const int, const GLenum, const int, const void*) { }
+	void	TexCoordPointer(const int, const GLenum, const int, const void*) { }
+	void	DrawArrays(const GLenum mode, const int first, const int count);
+
+	void	Present(void);
+
+	// Totals since creation
+	int		m_NbFrames;
+	int		m_NbDrawCalls;
+	int		m_NbVertices;
+	int		m_NbTextureBinds;
+
+private:
+	// Next texture ID to hand out
+	unsigned int	m_NextTexture;
+};
+
+
+#endif	/* _INCLUDED_SDLARENDERER_H */
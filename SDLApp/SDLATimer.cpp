@@ -0,0 +1,35 @@
+#include "SDLATimer.h"
+
+#ifdef	WIN32
+	#define	WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#else
+	#include <sys/time.h>
+#endif
+
+
+double SDLAGetTime(void)
+{
+#ifdef	WIN32
+
+	// Counter frequency never changes while the system is running
+	static double period = 0;
+	if (period == 0)
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		period = 1.0 / (double)frequency.QuadPart;
+	}
+
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return ((double)counter.QuadPart * period);
+
+#else
+
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return ((double)tv.tv_sec + (double)tv.tv_usec * 1e-6);
+
+#endif
+}
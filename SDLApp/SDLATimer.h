@@ -0,0 +1,10 @@
+#ifndef	_INCLUDED_SDLATIMER_H
+#define	_INCLUDED_SDLATIMER_H
+
+
+// High resolution time in seconds from an arbitrary starting point. SDL_GetTicks() only
+// has millisecond resolution which isn't enough to time individual frames.
+double	SDLAGetTime(void);
+
+
+#endif	/* _INCLUDED_SDLATIMER_H */
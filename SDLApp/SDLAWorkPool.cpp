@@ -0,0 +1,224 @@
+#include "SDLAWorkPool.h"
+#include "SDLAAtomic.h"
+#include "Exception.h"
+
+#ifndef	WIN32
+	#include <unistd.h>
+#endif
+
+
+cSDLAWorkPool::cSDLAWorkPool(const int nb_threads) :
+
+	m_NbThreads(nb_threads > 0 ? nb_threads : GetNbProcessors()),
+	m_Queues(0),
+	m_Workers(0),
+	m_StartSignal(0),
+	m_DoneSignal(0),
+	m_Quit(0)
+
+{
+	m_Queues = new Queue[m_NbThreads];
+	for (int i = 0; i < m_NbThreads; i++)
+	{
+		m_Queues[i].mutex = 0;
+		m_Queues[i].jobs = 0;
+		m_Queues[i].head = 0;
+		m_Queues[i].tail = 0;
+		m_Queues[i].capacity = 0;
+		m_Queues[i].nb_stolen = 0;
+	}
+
+	m_Workers = new Worker[m_NbThreads];
+	for (int i = 0; i < m_NbThreads; i++)
+	{
+		m_Workers[i].pool = this;
+		m_Workers[i].index = i;
+		m_Workers[i].thread = 0;
+	}
+
+	for (int i = 0; i < m_NbThreads; i++)
+	{
+		if ((m_Queues[i].mutex = SDL_CreateMutex()) == 0)
+			throw cException("Couldn't create a work queue mutex - %s", SDL_GetError());
+	}
+
+	if ((m_StartSignal = SDL_CreateSemaphore(0)) == 0 || (m_DoneSignal = SDL_CreateSemaphore(0)) == 0)
+		throw cException("Couldn't create the work pool semaphores - %s", SDL_GetError());
+
+	// The first thread is whoever calls Run()
+	for (int i = 1; i < m_NbThreads; i++)
+	{
+		if ((m_Workers[i].thread = SDL_CreateThread(WorkerThread, &m_Workers[i])) == 0)
+			throw cException("Couldn't create a work pool thread - %s", SDL_GetError());
+	}
+}
+
+
+cSDLAWorkPool::~cSDLAWorkPool(void)
+{
+	// Wake everyone up with nothing to do but quit
+	SDLAAtomicExchange(&m_Quit, 1);
+	for (int i = 1; i < m_NbThreads; i++)
+	{
+		if (m_Workers[i].thread)
+			SDL_SemPost(m_StartSignal);
+	}
+
+	for (int i = 1; i < m_NbThreads; i++)
+	{
+		if (m_Workers[i].thread)
+			SDL_WaitThread(m_Workers[i].thread, 0);
+	}
+
+	if (m_DoneSignal)
+		SDL_DestroySemaphore(m_DoneSignal);
+	if (m_StartSignal)
+		SDL_DestroySemaphore(m_StartSignal);
+
+	for (int i = 0; i < m_NbThreads; i++)
+	{
+		if (m_Queues[i].mutex)
+			SDL_DestroyMutex(m_Queues[i].mutex);
+		delete [] m_Queues[i].jobs;
+	}
+
+	delete [] m_Workers;
+	delete [] m_Queues;
+}
+
+
+void cSDLAWorkPool::Run(cSDLAJob** jobs, const int nb_jobs)
+{
+	// The workers are all waiting to start so the queues can be filled without locking
+	int per_queue = (nb_jobs + m_NbThreads - 1) / m_NbThreads;
+	for (int i = 0; i < m_NbThreads; i++)
+	{
+		Queue& queue = m_Queues[i];
+		if (queue.capacity < per_queue)
+		{
+			delete [] queue.jobs;
+			queue.jobs = new cSDLAJob*[per_queue];
+			queue.capacity = per_queue;
+		}
+
+		queue.head = 0;
+		queue.tail = 0;
+		queue.nb_stolen = 0;
+	}
+
+	// Deal the jobs out in turn so that each queue gets a similar mix
+	for (int i = 0; i < nb_jobs; i++)
+	{
+		Queue& queue = m_Queues[i % m_NbThreads];
+		queue.jobs[queue.tail++] = jobs[i];
+	}
+
+	for (int i = 1; i < m_NbThreads; i++)
+		SDL_SemPost(m_StartSignal);
+
+	Work(0);
+
+	// Each worker only stops once every queue is empty and its own last job is done
+	for (int i = 1; i < m_NbThreads; i++)
+		SDL_SemWait(m_DoneSignal);
+}
+
+
+int cSDLAWorkPool::GetNbStolen(void) const
+{
+	int nb_stolen = 0;
+	for (int i = 0; i < m_NbThreads; i++)
+		nb_stolen += m_Queues[i].nb_stolen;
+
+	return (nb_stolen);
+}
+
+
+int cSDLAWorkPool::GetNbProcessors(void)
+{
+#ifdef	WIN32
+
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (info.dwNumberOfProcessors);
+
+#else
+
+	long nb_processors = sysconf(_SC_NPROCESSORS_ONLN);
+	return (nb_processors > 0 ? (int)nb_processors : 1);
+
+#endif
+}
+
+
+cSDLAJob* cSDLAWorkPool::PopJob(const int thread_index)
+{
+	Queue& queue = m_Queues[thread_index];
+	cSDLAJob* job = 0;
+
+	// Take the last job queued, the one most likely to share data with the last one run
+	SDL_LockMutex(queue.mutex);
+	if (queue.head != queue.tail)
+		job = queue.jobs[--queue.tail];
+	SDL_UnlockMutex(queue.mutex);
+
+	return (job);
+}
+
+
+cSDLAJob* cSDLAWorkPool::StealJob(const int thread_index)
+{
+	// Try everyone else in turn, starting with the next thread along so that thieves
+	// spread themselves out
+	for (int i = 1; i < m_NbThreads; i++)
+	{
+		Queue& queue = m_Queues[(thread_index + i) % m_NbThreads];
+		cSDLAJob* job = 0;
+
+		// Steal from the opposite end to the owner so the two rarely want the same job
+		SDL_LockMutex(queue.mutex);
+		if (queue.head != queue.tail)
+			job = queue.jobs[queue.head++];
+		SDL_UnlockMutex(queue.mutex);
+
+		if (job)
+		{
+			m_Queues[thread_index].nb_stolen++;
+			return (job);
+		}
+	}
+
+	return (0);
+}
+
+
+void cSDLAWorkPool::Work(const int thread_index)
+{
+	while (1)
+	{
+		cSDLAJob* job = PopJob(thread_index);
+		if (job == 0 && (job = StealJob(thread_index)) == 0)
+			break;
+
+		job->Execute(thread_index);
+	}
+}
+
+
+int cSDLAWorkPool::WorkerThread(void* data)
+{
+	Worker* worker = (Worker*)data;
+	cSDLAWorkPool* pool = worker->pool;
+
+	while (1)
+	{
+		SDL_SemWait(pool->m_StartSignal);
+		if (SDLAAtomicLoad(&pool->m_Quit))
+			break;
+
+		pool->Work(worker->index);
+		SDL_SemPost(pool->m_DoneSignal);
+	}
+
+	return (0);
+}
@@ -0,0 +1,92 @@
+#ifndef	_INCLUDED_SDLAWORKPOOL_H
+#define	_INCLUDED_SDLAWORKPOOL_H
+
+
+#ifndef	_SDL_H
+	#include <SDL.h>
+#endif
+
+
+// A piece of work to be run by a cSDLAWorkPool. Jobs are independent of each other, must
+// not throw and must stay alive until the Run() they were given to returns.
+class cSDLAJob
+{
+public:
+	virtual ~cSDLAJob(void) { }
+
+	// Thread index is zero for the thread that called Run() and 1 to N-1 for the workers,
+	// handy for giving each thread its own scratch space
+	virtual void	Execute(const int thread_index) = 0;
+};
+
+
+// Runs batches of jobs across a fixed set of threads. Each thread has its own queue of jobs
+// which it works through from the back; once that's empty it steals from the front of the
+// others until there's nothing left anywhere. The thread that calls Run() takes part as
+// well so a pool of one thread just runs everything in order.
+class cSDLAWorkPool
+{
+public:
+	// Zero threads means one per processor
+	cSDLAWorkPool(const int nb_threads);
+	~cSDLAWorkPool(void);
+
+	// Execute all the jobs, returning when they've finished
+	void	Run(cSDLAJob** jobs, const int nb_jobs);
+
+	int		GetNbThreads(void) const { return (m_NbThreads); }
+
+	// Number of jobs in the last Run() that were executed by a thread other than the one
+	// they were queued on
+	int		GetNbStolen(void) const;
+
+	// Number of processors in the system
+	static int	GetNbProcessors(void);
+
+private:
+	struct Queue
+	{
+		SDL_mutex*	mutex;
+
+		// Jobs still to run are the ones from head up to, but not including, tail
+		cSDLAJob**	jobs;
+		int			head;
+		int			tail;
+		int			capacity;
+
+		// Jobs this thread took from the other queues in the last Run()
+		int			nb_stolen;
+	};
+
+	struct Worker
+	{
+		cSDLAWorkPool*	pool;
+		int				index;
+		SDL_Thread*		thread;
+	};
+
+	cSDLAJob*	PopJob(const int thread_index);
+	cSDLAJob*	StealJob(const int thread_index);
+	void		Work(const int thread_index);
+
+	static int	WorkerThread(void* data);
+
+	int		m_NbThreads;
+
+	// One queue per thread, including the caller of Run()
+	Queue*	m_Queues;
+
+	// The threads other than the caller
+	Worker*	m_Workers;
+
+	// Workers wait on the first for a batch to start, and signal the second when they can
+	// no longer find anything to do
+	SDL_sem*	m_StartSignal;
+	SDL_sem*	m_DoneSignal;
+
+	// Set to tell the workers to exit next time they're started
+	volatile long	m_Quit;
+};
+
+
+#endif	/* _INCLUDED_SDLAWORKPOOL_H */
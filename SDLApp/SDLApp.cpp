@@ -1,39 +1,149 @@
 
 #include "SDLApp.h"
+#include "SDLAAtomic.h"
 #include "SDLAFont.h"
+#include "SDLAProfiler.h"
+#include "SDLARenderer.h"
+#include "SDLATimer.h"
+#include <cstdio>
+#include <cstdlib>
 #include <cstring>
 
 
+int			cSDLApp::s_HeadlessFrames = 0;
+const char*	cSDLApp::s_ReplayFilename = 0;
+const char*	cSDLApp::s_RecordFilename = 0;
+const char*	cSDLApp::s_TraceFilename = 0;
+bool		cSDLApp::s_IsThreaded = false;
+
+
+// Step used when running headless and for the first frame
+static const float DEFAULT_FRAME_TIME = 1.0f / 60.0f;
+
+// Longest step taken after a stall, such as a video mode switch
+static const float MAX_FRAME_TIME = 0.1f;
+
+// Most simulation steps taken at once before the simulation gives up on catching up
+static const int MAX_SIMULATION_STEPS = 8;
+
+
+namespace
+{
+	int CompareTimes(const void* a, const void* b)
+	{
+		double da = *(const double*)a;
+		double db = *(const double*)b;
+		return (da < db ? -1 : (da > db ? 1 : 0));
+	}
+};
+
+
 cSDLApp::cSDLApp(const int width, const int height, const bool is_2d) :
 
+	m_Renderer(0),
+	m_IsHeadless(s_HeadlessFrames > 0),
+	m_Profiler(0),
+	m_SimProfiler(0),
+	m_FrameTime(DEFAULT_FRAME_TIME),
 	m_Width(width),
 	m_Height(height),
 	m_MouseX(0),
 	m_MouseY(0),
 	m_MouseButtons(0),
+	m_VideoInfo(0),
 	m_IsFullscreen(false),
-	m_Is2D(is_2d)
+	m_Is2D(is_2d),
+	m_FrameIndex(0),
+	m_NbReplayEvents(0),
+	m_ReplayEvents(0),
+	m_RecordFile(0),
+	m_SimStep(0),
+	m_SimBacklog(0),
+	m_IsThreaded(s_IsThreaded && s_HeadlessFrames == 0),
+	m_SimThread(0),
+	m_StopSimulation(0),
+	m_SimulationFailed(0)
 
 {
 	// Clear key-state array
 	memset(m_Keys, 0, sizeof(m_Keys));
 
-	// Initialise SDL
-	if (SDL_Init(SDL_INIT_VIDEO) < 0)
-		cException("Error initialising SDL - %d", SDL_GetError());
+	m_Profiler = new cSDLAProfiler;
+	m_SimProfiler = new cSDLAProfiler;
+	if (s_TraceFilename)
+		m_Profiler->StartTrace(s_TraceFilename);
+
+	if (m_IsHeadless)
+	{
+		// Nothing but the core of SDL is needed
+		if (SDL_Init(0) < 0)
+			throw cException("Error initialising SDL - %s", SDL_GetError());
+
+		m_Renderer = new cSDLANullRenderer;
+
+		if (s_ReplayFilename)
+			LoadReplay(s_ReplayFilename);
+	}
 
-	// Setup OpenGL
-	SetupOpenGL(is_2d);
+	else
+	{
+		// Initialise SDL
+		if (SDL_Init(SDL_INIT_VIDEO) < 0)
+			cException("Error initialising SDL - %d", SDL_GetError());
+
+		m_Renderer = new cSDLAGLRenderer;
+
+		// Setup OpenGL
+		SetupOpenGL(is_2d);
+
+		// Open the file to record key presses to
+		if (s_RecordFilename && (m_RecordFile = fopen(s_RecordFilename, "w")) == 0)
+			throw cException("Couldn't open file %s", s_RecordFilename);
+	}
 }
 
 
 cSDLApp::~cSDLApp(void)
 {
+	// In case Run left through an exception
+	StopSimulation();
+
+	if (m_RecordFile)
+		fclose(m_RecordFile);
+
+	delete [] m_ReplayEvents;
+	delete m_Renderer;
+	delete m_SimProfiler;
+	delete m_Profiler;
+
 	// Shutdown SDL
 	SDL_Quit();
 }
 
 
+void cSDLApp::ParseCommandLine(int argc, char* argv[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		// Options without a value
+		if (strcmp(argv[i], "-threaded") == 0)
+			s_IsThreaded = true;
+
+		// The rest need one after them
+		else if (i == argc - 1)
+			break;
+		else if (strcmp(argv[i], "-headless") == 0)
+			s_HeadlessFrames = atoi(argv[++i]);
+		else if (strcmp(argv[i], "-replay") == 0)
+			s_ReplayFilename = argv[++i];
+		else if (strcmp(argv[i], "-record") == 0)
+			s_RecordFilename = argv[++i];
+		else if (strcmp(argv[i], "-trace") == 0)
+			s_TraceFilename = argv[++i];
+	}
+}
+
+
 void cSDLApp::SetupOpenGL(const bool is_2d)
 {
 	// Retrieve current video info
@@ -119,10 +229,31 @@ void cSDLApp::Run(void)
 	// Can't set in constructor - vtable doesn't exist
 	AfterSwitch();
 
+	StartSimulation();
+
+	if (m_IsHeadless)
+		RunHeadless();
+	else
+		RunWindowed();
+
+	StopSimulation();
+}
+
+
+void cSDLApp::SetSimulationStep(const float dt)
+{
+	m_SimStep = dt;
+}
+
+
+void cSDLApp::RunWindowed(void)
+{
 	while (1)
 	{
 		SDL_Event	event;
 
+		m_Profiler->BeginFrame();
+
 		// Backup current frame keys
 		memcpy(m_KeysLastFrame, m_Keys, sizeof(m_Keys));
 
@@ -132,8 +263,14 @@ void cSDLApp::Run(void)
 			switch (event.type)
 			{
 				// Handle key presses
-				case (SDL_KEYDOWN):	m_Keys[event.key.keysym.sym] = true;	break;
-				case (SDL_KEYUP):	m_Keys[event.key.keysym.sym] = false;	break;
+				case (SDL_KEYDOWN):
+				case (SDL_KEYUP):
+					m_Keys[event.key.keysym.sym] = (event.type == SDL_KEYDOWN);
+
+					// Keep it for replaying later
+					if (m_RecordFile)
+						fprintf(m_RecordFile, "%d %d %d\n", m_FrameIndex, event.key.keysym.sym, event.type == SDL_KEYDOWN);
+					break;
 
 
 				// Handle program exit
@@ -143,8 +280,7 @@ void cSDLApp::Run(void)
 		}
 
 		// Set the key released states
-		for (int i = 0; i < SDLK_LAST; i++)
-			m_KeysReleased[i] = (m_KeysLastFrame[i] ^ m_Keys[i]) & m_KeysLastFrame[i];
+		UpdateKeysReleased();
 
 		// Get the current mouse state
 		m_MouseButtons = SDL_GetMouseState(&m_MouseX, &m_MouseY);
@@ -166,20 +302,230 @@ void cSDLApp::Run(void)
 		}
 
 
+		// Pass on any errors from the simulation thread
+		if (SDLAAtomicLoad(&m_SimulationFailed))
+			throw cException("%s", m_SimulationError);
+
+		// Bring the simulation up to date when it's not on its own thread
+		if (m_IsThreaded == false)
+		{
+			m_Profiler->BeginSection("Simulate");
+			StepSimulation(m_FrameTime);
+			m_Profiler->EndSection();
+		}
+
 		// --- CALL USER CODE ---
-		if (ProcessFrame() == false)
+		m_Profiler->BeginSection("ProcessFrame");
+		bool carry_on = ProcessFrame();
+		m_Profiler->EndSection();
+
+		if (carry_on == false)
 			return;
 		// ----------------------
 
 
 		// Make frame changes visible
-		SDL_GL_SwapBuffers();
-		glFlush();
+		m_Profiler->BeginSection("Present");
+		m_Renderer->Present();
+		m_Profiler->EndSection();
+
+		m_Profiler->EndFrame();
+		m_FrameIndex++;
+
+		// Advance the next frame by however long this one took
+		m_FrameTime = (float)m_Profiler->GetFrameTime();
+		if (m_FrameTime > MAX_FRAME_TIME)
+			m_FrameTime = MAX_FRAME_TIME;
 	}
 }
 
 
+void cSDLApp::UpdateKeysReleased(void)
+{
+	for (int i = 0; i < SDLK_LAST; i++)
+		m_KeysReleased[i] = (m_KeysLastFrame[i] ^ m_Keys[i]) & m_KeysLastFrame[i];
+}
+
+
+void cSDLApp::RunHeadless(void)
+{
+	double* times = new double[s_HeadlessFrames];
+	int next_event = 0;
+
+	for (m_FrameIndex = 0; m_FrameIndex < s_HeadlessFrames; )
+	{
+		// Backup current frame keys
+		memcpy(m_KeysLastFrame, m_Keys, sizeof(m_Keys));
+
+		// Play back all key changes recorded for this frame
+		for ( ; next_event < m_NbReplayEvents && m_ReplayEvents[next_event].frame <= m_FrameIndex; next_event++)
+			m_Keys[m_ReplayEvents[next_event].key] = m_ReplayEvents[next_event].down;
+
+		UpdateKeysReleased();
+
+		m_Profiler->BeginFrame();
+
+		// Always on this thread, with fixed frame times the results are repeatable
+		m_Profiler->BeginSection("Simulate");
+		StepSimulation(m_FrameTime);
+		m_Profiler->EndSection();
+
+		// Time only the user code
+		double start = SDLAGetTime();
+		m_Profiler->BeginSection("ProcessFrame");
+		bool carry_on = ProcessFrame();
+		m_Profiler->EndSection();
+		times[m_FrameIndex++] = SDLAGetTime() - start;
+
+		m_Renderer->Present();
+		m_Profiler->EndFrame();
+
+		if (carry_on == false || m_Keys[SDLK_ESCAPE])
+			break;
+	}
+
+	ReportFrameTimes(times, m_FrameIndex);
+	delete [] times;
+}
+
+
+void cSDLApp::StartSimulation(void)
+{
+	if (m_SimStep == 0 || m_IsThreaded == false)
+		return;
+
+	m_StopSimulation = 0;
+	m_SimulationFailed = 0;
+	if ((m_SimThread = SDL_CreateThread(SimulationThread, this)) == 0)
+		throw cException("Couldn't create the simulation thread - %s", SDL_GetError());
+}
+
+
+void cSDLApp::StopSimulation(void)
+{
+	if (m_SimThread == 0)
+		return;
+
+	SDLAAtomicExchange(&m_StopSimulation, 1);
+	SDL_WaitThread(m_SimThread, 0);
+	m_SimThread = 0;
+}
+
+
+void cSDLApp::StepSimulation(const double elapsed)
+{
+	if (m_SimStep == 0)
+		return;
+
+	m_SimBacklog += elapsed;
+
+	// Drop time the simulation can't catch up on rather than falling further behind
+	if (m_SimBacklog > m_SimStep * MAX_SIMULATION_STEPS)
+		m_SimBacklog = m_SimStep * MAX_SIMULATION_STEPS;
+
+	while (m_SimBacklog >= m_SimStep)
+	{
+		m_SimProfiler->BeginFrame();
+		Simulate(m_SimStep);
+		m_SimProfiler->EndFrame();
+
+		m_SimBacklog -= m_SimStep;
+	}
+}
+
+
+int cSDLApp::SimulationThread(void* data)
+{
+	cSDLApp* app = (cSDLApp*)data;
+
+	try
+	{
+		double last = SDLAGetTime();
+
+		while (SDLAAtomicLoad(&app->m_StopSimulation) == 0)
+		{
+			double now = SDLAGetTime();
+			app->StepSimulation(now - last);
+			last = now;
+
+			// Give the time back until the next step is due
+			if (app->m_SimBacklog < app->m_SimStep)
+				SDL_Delay((Uint32)((app->m_SimStep - app->m_SimBacklog) * 1000));
+		}
+	}
+
+	// Hand the error over to the main thread to report
+	catch (const cException& exception)
+	{
+		strcpy(app->m_SimulationError, exception.GetErrorMessage());
+		SDLAAtomicExchange(&app->m_SimulationFailed, 1);
+	}
+
+	return (0);
+}
+
+
+void cSDLApp::LoadReplay(const char* filename)
+{
+	FILE* fp = fopen(filename, "r");
+	if (fp == 0)
+		throw cException("Couldn't open file %s", filename);
+
+	int frame, key, down;
+
+	// Count the events first
+	while (fscanf(fp, "%d %d %d", &frame, &key, &down) == 3)
+		m_NbReplayEvents++;
+
+	m_ReplayEvents = new KeyEvent[m_NbReplayEvents];
+	rewind(fp);
+
+	// They're recorded in frame order
+	for (int i = 0; i < m_NbReplayEvents && fscanf(fp, "%d %d %d", &frame, &key, &down) == 3; i++)
+	{
+		if (key < 0 || key >= SDLK_LAST)
+			throw cException("Bad key %d in replay file %s", key, filename);
+
+		m_ReplayEvents[i].frame = frame;
+		m_ReplayEvents[i].key = key;
+		m_ReplayEvents[i].down = down != 0;
+	}
+
+	fclose(fp);
+}
+
+
+void cSDLApp::ReportFrameTimes(double* times, const int nb_frames) const
+{
+	if (nb_frames == 0)
+		return;
+
+	// Sort to pick out the percentiles
+	qsort(times, nb_frames, sizeof(double), CompareTimes);
+
+	double total = 0;
+	for (int i = 0; i < nb_frames; i++)
+		total += times[i];
+
+	printf("%d frames, ProcessFrame CPU time (ms):\n", nb_frames);
+	printf("  mean %.3f  p50 %.3f  p90 %.3f  p95 %.3f  p99 %.3f  max %.3f\n",
+		1000 * total / nb_frames,
+		1000 * times[nb_frames * 50 / 100],
+		1000 * times[nb_frames * 90 / 100],
+		1000 * times[nb_frames * 95 / 100],
+		1000 * times[nb_frames * 99 / 100],
+		1000 * times[nb_frames - 1]);
+
+	// Amount of work that would have been sent to the GPU
+	const cSDLANullRenderer* renderer = static_cast<const cSDLANullRenderer*>(m_Renderer);
+	printf("  per frame: %.1f draw calls, %.1f vertices, %.1f texture binds\n",
+		(float)renderer->m_NbDrawCalls / nb_frames,
+		(float)renderer->m_NbVertices / nb_frames,
+		(float)renderer->m_NbTextureBinds / nb_frames);
+}
+
+
 cSDLAFont* cSDLApp::CreateFont(const char* font_db) const
 {
-	return (new cSDLAFont(font_db, m_Width, m_Height));
+	return (new cSDLAFont(font_db, m_Width, m_Height, m_Renderer));
 }
\ No newline at end of file
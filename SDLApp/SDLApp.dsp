@@ -101,8 +101,28 @@ SOURCE=.\SDLAFont.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=.\SDLAMappedFile.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=.\SDLApp.cpp
 # End Source File
+# Begin Source File
+
+SOURCE=.\SDLAProfiler.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\SDLARenderer.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\SDLATimer.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=.\SDLAWorkPool.cpp
+# End Source File
 # End Group
 # Begin Group "Header Files"
 
@@ -113,16 +133,48 @@ SOURCE=.\Exception.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\SDLAAtomic.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\SDLAFont.h
 # End Source File
 # Begin Source File
 
+SOURCE=.\SDLAFontFormat.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\SDLAMappedFile.h
+# End Source File
+# Begin Source File
+
 SOURCE=.\SDLApp.h
 # End Source File
 # Begin Source File
 
 SOURCE=.\SDLAppRun.h
 # End Source File
+# Begin Source File
+
+SOURCE=.\SDLAProfiler.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\SDLARenderer.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\SDLATimer.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\SDLATripleBuffer.h
+# End Source File
+# Begin Source File
+
+SOURCE=.\SDLAWorkPool.h
+# End Source File
 # End Group
 # End Target
 # End Project
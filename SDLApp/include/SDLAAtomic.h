@@ -0,0 +1,117 @@
+#ifndef	_INCLUDED_SDLAATOMIC_H
+#define	_INCLUDED_SDLAATOMIC_H
+
+
+// SDL 1.2 only provides mutexes, so these wrap the platform's interlocked operations for
+// sharing data between threads without locking. All of them act as a full memory barrier.
+
+
+#ifdef	WIN32
+	#define	WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#endif
+
+
+// Swap in a new value, returning the previous one
+inline long SDLAAtomicExchange(volatile long* target, const long value)
+{
+#ifdef	WIN32
+	return (InterlockedExchange((long*)target, value));
+#else
+	// The builtin exchange is only an acquire barrier, so swap with a full barrier instead
+	long old = __sync_fetch_and_add(target, 0);
+	long seen;
+	while ((seen = __sync_val_compare_and_swap(target, old, value)) != old)
+		old = seen;
+	return (old);
+#endif
+}
+
+
+// Store the value only if the target currently holds the comparand. Returns the previous
+// value, which equals the comparand if the store happened.
+inline long SDLAAtomicCompareExchange(volatile long* target, const long value, const long comparand)
+{
+#if	defined(_MSC_VER) && _MSC_VER <= 1200
+	// The VC6 headers only have the pointer version
+	return ((long)InterlockedCompareExchange((void**)target, (void*)value, (void*)comparand));
+#elif	defined(WIN32)
+	return (InterlockedCompareExchange((long*)target, value, comparand));
+#else
+	return (__sync_val_compare_and_swap(target, comparand, value));
+#endif
+}
+
+
+// Add or subtract one, returning the new value
+inline long SDLAAtomicIncrement(volatile long* target)
+{
+#ifdef	WIN32
+	return (InterlockedIncrement((long*)target));
+#else
+	return (__sync_add_and_fetch(target, 1));
+#endif
+}
+
+
+inline long SDLAAtomicDecrement(volatile long* target)
+{
+#ifdef	WIN32
+	return (InterlockedDecrement((long*)target));
+#else
+	return (__sync_sub_and_fetch(target, 1));
+#endif
+}
+
+
+// Read a value written by another thread, seeing everything written before it
+inline long SDLAAtomicLoad(volatile long* target)
+{
+	return (SDLAAtomicCompareExchange(target, 0, 0));
+}
+
+
+// Pointer versions of the above for publishing objects between threads
+inline void* SDLAAtomicExchangePointer(void* volatile* target, void* value)
+{
+#if	defined(_WIN64)
+	return (InterlockedExchangePointer((void**)target, value));
+#elif	defined(WIN32)
+	return ((void*)InterlockedExchange((long*)target, (long)value));
+#else
+	void* old = __sync_val_compare_and_swap(target, (void*)0, (void*)0);
+	void* seen;
+	while ((seen = __sync_val_compare_and_swap(target, old, value)) != old)
+		old = seen;
+	return (old);
+#endif
+}
+
+
+// Store the pointer only if the target currently holds the comparand, returning the
+// previous pointer
+inline void* SDLAAtomicCompareExchangePointer(void* volatile* target, void* value, void* comparand)
+{
+#if	defined(_MSC_VER) && _MSC_VER <= 1200
+	return (InterlockedCompareExchange((void**)target, value, comparand));
+#elif	defined(WIN32)
+	return (InterlockedCompareExchangePointer((void**)target, value, comparand));
+#else
+	return (__sync_val_compare_and_swap(target, comparand, value));
+#endif
+}
+
+
+inline void* SDLAAtomicLoadPointer(void* volatile* target)
+{
+#if	defined(_MSC_VER) && _MSC_VER <= 1200
+	return (InterlockedCompareExchange((void**)target, 0, 0));
+#elif	defined(WIN32)
+	return (InterlockedCompareExchangePointer((void**)target, 0, 0));
+#else
+	return (__sync_val_compare_and_swap(target, (void*)0, (void*)0));
+#endif
+}
+
+
+#endif	/* _INCLUDED_SDLAATOMIC_H */
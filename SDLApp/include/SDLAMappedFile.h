@@ -0,0 +1,26 @@
+#ifndef	_INCLUDED_SDLAMAPPEDFILE_H
+#define	_INCLUDED_SDLAMAPPEDFILE_H
+
+
+// Read-only view of an entire file mapped into memory
+class cSDLAMappedFile
+{
+public:
+	cSDLAMappedFile(const char* filename);
+	~cSDLAMappedFile(void);
+
+	const unsigned char*	GetData(void) const;
+	int						GetSize(void) const;
+
+private:
+	// Start of the mapping and its length
+	const unsigned char*	m_Data;
+	int						m_Size;
+
+	// Platform handles for the open file and mapping
+	void*	m_File;
+	void*	m_Mapping;
+};
+
+
+#endif	/* _INCLUDED_SDLAMAPPEDFILE_H */
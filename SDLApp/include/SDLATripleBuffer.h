@@ -0,0 +1,89 @@
+#ifndef	_INCLUDED_SDLATRIPLEBUFFER_H
+#define	_INCLUDED_SDLATRIPLEBUFFER_H
+
+
+#ifndef	_INCLUDED_SDLAATOMIC_H
+	#include "SDLAAtomic.h"
+#endif
+
+
+// Hands complete copies of some state from one producer thread to one consumer thread
+// without either ever waiting on the other. The producer fills in the back copy and
+// publishes it, the consumer picks up the most recent published copy whenever it likes.
+// Copies the consumer never got round to are simply overwritten.
+//
+// The third copy sits between the two and is swapped with either side through a single
+// atomic exchange of its index, with a flag set when it holds something new.
+template <typename T> class tSDLATripleBuffer
+{
+public:
+	tSDLATripleBuffer(void) : m_Back(0), m_Shared(1), m_Front(2)
+	{
+	}
+
+
+	// Copy being written by the producer
+	T& GetBack(void)
+	{
+		return (m_Copies[m_Back]);
+	}
+
+
+	// Make the back copy available to the consumer and take over the one it replaces
+	void Publish(void)
+	{
+		long previous = SDLAAtomicExchange(&m_Shared, m_Back | NEW_DATA);
+		m_Back = previous & INDEX_MASK;
+	}
+
+
+	// Swap in the latest published copy if there is one, returning true if it changed
+	bool Acquire(void)
+	{
+		// Only the producer sets the flag so checking it first is safe
+		if ((SDLAAtomicLoad(&m_Shared) & NEW_DATA) == 0)
+			return (false);
+
+		long previous = SDLAAtomicExchange(&m_Shared, m_Front);
+		m_Front = previous & INDEX_MASK;
+		return (true);
+	}
+
+
+	// Copy being read by the consumer
+	const T& GetFront(void) const
+	{
+		return (m_Copies[m_Front]);
+	}
+
+
+	// Direct access to each copy, only safe before the threads start
+	T& operator [] (const int index)
+	{
+		return (m_Copies[index]);
+	}
+
+
+private:
+	enum
+	{
+		INDEX_MASK = 3,
+
+		// Shared copy hasn't been picked up yet
+		NEW_DATA = 4
+	};
+
+	T	m_Copies[3];
+
+	// Only touched by the producer
+	long	m_Back;
+
+	// Index of the copy in the middle along with the new data flag
+	volatile long	m_Shared;
+
+	// Only touched by the consumer
+	long	m_Front;
+};
+
+
+#endif	/* _INCLUDED_SDLATRIPLEBUFFER_H */
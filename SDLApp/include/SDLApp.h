@@ -23,12 +23,19 @@
 #endif
 
 
-// OpenGL stuff
-#include <gl/gl.h>
-#include <gl/glu.h>
+// OpenGL stuff, which is in a directory with a capitalised name everywhere but Windows
+#ifdef	WIN32
+	#include <gl/gl.h>
+	#include <gl/glu.h>
+#else
+	#include <GL/gl.h>
+	#include <GL/glu.h>
+#endif
 
 
 class cSDLAFont;
+class cSDLARenderer;
+class cSDLAProfiler;
 
 
 class cSDLApp
@@ -41,6 +48,17 @@ public:
 	// Run the application
 	void	Run(void);
 
+	// Pick up the SDLApp options before the application is created:
+	//
+	//		-headless <frames>	Run for a number of frames without a window or OpenGL and
+	//							report how long ProcessFrame took
+	//		-replay <file>		Play back key presses while running headless
+	//		-record <file>		Save key presses in a windowed run for replaying later
+	//		-trace <file>		Write the profiled frames out for chrome://tracing
+	//		-threaded			Run the simulation on its own thread
+	//
+	static void	ParseCommandLine(int argc, char* argv[]);
+
 protected:
 	// Called every frame
 	virtual bool	ProcessFrame(void) = 0;
@@ -50,9 +68,34 @@ protected:
 	virtual void	BeforeSwitch(void) = 0;
 	virtual void	AfterSwitch(void) = 0;
 
+	// Called with a fixed timestep once SetSimulationStep() has been used, as many times as
+	// needed to keep up with real time. This is on the main thread just before ProcessFrame
+	// unless -threaded is given, in which case it runs on its own thread and must only hand
+	// state to ProcessFrame through something like a tSDLATripleBuffer.
+	virtual void	Simulate(const float) { }
+
+	// Turn on the fixed timestep simulation, call from the constructor
+	void	SetSimulationStep(const float dt);
+
 	// Create a font using the required database
 	cSDLAFont*	CreateFont(const char* font_db) const;
 
+	// All drawing goes through this so that it can run without OpenGL
+	cSDLARenderer*	m_Renderer;
+
+	// Running without a window?
+	bool	m_IsHeadless;
+
+	// Frame timing, wrap sections of ProcessFrame with cSDLAScopedTimer to see them in the HUD
+	cSDLAProfiler*	m_Profiler;
+
+	// Separate timing of each simulation step, only use this from Simulate
+	cSDLAProfiler*	m_SimProfiler;
+
+	// Time in seconds to advance the application by this frame. This is the length of the
+	// last frame when windowed and a fixed 60Hz step when headless.
+	float	m_FrameTime;
+
 	// Window dimensions
 	int		m_Width;
 	int		m_Height;
@@ -77,10 +120,64 @@ protected:
 	bool	m_Is2D;
 
 private:
+	struct KeyEvent
+	{
+		// Frame the key changed on
+		int		frame;
+
+		// SDLK_* constant
+		int		key;
+
+		// Pressed or released?
+		bool	down;
+	};
+
 	void	SetupOpenGL(const bool is_2d);
 
+	void	UpdateKeysReleased(void);
+
+	void	RunWindowed(void);
+	void	RunHeadless(void);
+
+	void	StartSimulation(void);
+	void	StopSimulation(void);
+	void	StepSimulation(const double elapsed);
+	static int	SimulationThread(void* data);
+	void	LoadReplay(const char* filename);
+	void	ReportFrameTimes(double* times, const int nb_frames) const;
+
 	// Array of key-presses for the last frame
 	bool	m_KeysLastFrame[SDLK_LAST];
+
+	// Frames since the application started running
+	int		m_FrameIndex;
+
+	// Key events to play back in headless mode
+	int			m_NbReplayEvents;
+	KeyEvent*	m_ReplayEvents;
+
+	// File key events are being recorded to
+	FILE*	m_RecordFile;
+
+	// Length of each simulation step, zero if there's no simulation
+	float	m_SimStep;
+
+	// Time the simulation still has to catch up on
+	double	m_SimBacklog;
+
+	// Simulation thread and the flags shared with it
+	bool			m_IsThreaded;
+	SDL_Thread*		m_SimThread;
+	volatile long	m_StopSimulation;
+	volatile long	m_SimulationFailed;
+	char			m_SimulationError[512];
+
+	// Options from the command line
+	static int			s_HeadlessFrames;
+	static const char*	s_ReplayFilename;
+	static const char*	s_RecordFilename;
+	static const char*	s_TraceFilename;
+	static bool			s_IsThreaded;
 };
 
 
@@ -13,6 +13,8 @@ int main(int argc, char* argv[])
 	// Execute me
 	try
 	{
+		cSDLApp::ParseCommandLine(argc, argv);
+
 		SDL_APP_TYPE app(640, 480);
 		app.Run();
 	}
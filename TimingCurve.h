@@ -0,0 +1,161 @@
+#ifndef	_INCLUDED_TIMINGCURVE_H
+#define	_INCLUDED_TIMINGCURVE_H
+
+
+#include <cmath>
+
+
+// A timing curve bakes the complete mapping from normalised time to curve parameter for
+// a fixed easing function on a fixed curve. Evaluating a follower then costs a single
+// table lookup and one evaluation of the curve, rather than the easing function, the
+// arc-length scale and a Newton-Raphson inversion each time.
+struct TimingCurve
+{
+	TimingCurve(void) : nb_entries(0), entries(0)
+	{
+	}
+
+
+	~TimingCurve(void)
+	{
+		// Release all memory
+		delete [] entries;
+	}
+
+
+	struct Knot
+	{
+		// Normalised time
+		float	t;
+
+		// Curve parameter at that time
+		float	u;
+
+		// Next knot in the linked list
+		Knot*	next;
+
+
+		static Knot* Append(Knot* last, const float t, const float u)
+		{
+			// Create the new knot at the end of the list
+			Knot* add = new Knot;
+			add->t = t;
+			add->u = u;
+			add->next = 0;
+			last->next = add;
+
+			return (add);
+		}
+	};
+
+
+	// The function type F needs to provide L() and GetParameterNewtonRaphson(), while the
+	// easing function E maps normalised time onto normalised arc-length. Both ends of the
+	// time range are assumed to map to the ends of the curve.
+	// The tolerance is the maximum allowed error in the curve parameter when linearly
+	// interpolating between two knots, measured at each segment's midpoint and quarter
+	// points. The maximum distance forces subdivision so that these tests can't be fooled
+	// by large symmetric segments.
+	template <typename F, typename E> void Init(const F& f, const E& ease, const float tolerance, const float max_dist)
+	{
+		struct Segment
+		{
+			static Knot* Process(const F& f, const E& ease, const float length, const float t0, const float u0, const float t1, const float u1, const float max_dist, const float tolerance, Knot* last)
+			{
+				// Evaluate the exact mapping at the midpoint and quarter points of the segment
+				float t = (t0 + t1) / 2;
+				float u = f.GetParameterNewtonRaphson(ease(t) * length);
+				float ua = f.GetParameterNewtonRaphson(ease((t0 + t) / 2) * length);
+				float ub = f.GetParameterNewtonRaphson(ease((t + t1) / 2) * length);
+
+				// Too much error?
+				if (t1 - t0 > max_dist ||
+					fabs(u - (u0 + u1) / 2) > tolerance ||
+					fabs(ua - (u0 * 3 + u1) / 4) > tolerance ||
+					fabs(ub - (u0 + u1 * 3) / 4) > tolerance)
+				{
+					// Further split the two halves of this segment, in order
+					last = Process(f, ease, length, t0, u0, t, u, max_dist, tolerance, last);
+					last = Process(f, ease, length, t, u, t1, u1, max_dist, tolerance, last);
+					return (last);
+				}
+
+				// Just fine, add the end of the segment
+				return (Knot::Append(last, t1, u1));
+			}
+		};
+
+		// Create the top of the linked knot list, contains the <0, 0> entry
+		Knot* knots = new Knot;
+		knots->t = 0;
+		knots->u = 0;
+		knots->next = 0;
+
+		Segment::Process(f, ease, f.L(0, 1), 0, 0, 1, 1, max_dist, tolerance, knots);
+
+		// Count the number of entries in the table
+		int count = 0;
+		Knot* cur;
+		for (cur = knots; cur; cur = cur->next)
+			count++;
+
+		// Allocate the table, replacing any previous one
+		delete [] entries;
+		entries = new float[2 * count];
+		nb_entries = count;
+
+		// Copy all knots, releasing the list along the way
+		int i = 0;
+		for (cur = knots; cur; i++)
+		{
+			entries[i * 2 + 0] = cur->t;
+			entries[i * 2 + 1] = cur->u;
+
+			Knot* next = cur->next;
+			delete cur;
+			cur = next;
+		}
+	}
+
+
+	float GetParameter(const float t) const
+	{
+		int min_i = 0, max_i = nb_entries - 1;
+		int mid_point;
+
+		// Clamp to the baked range
+		if (t <= entries[0])
+			return (entries[1]);
+		if (t >= entries[max_i * 2])
+			return (entries[max_i * 2 + 1]);
+
+		// Search for the knot below the requested time
+		while (max_i - min_i > 1)
+		{
+			mid_point = (min_i + max_i) >> 1;
+
+			if (t >= entries[mid_point * 2])
+				min_i = mid_point;
+			else
+				max_i = mid_point;
+		}
+
+		// Get knots on either side of the input
+		float t0 = entries[min_i * 2 + 0];
+		float t1 = entries[min_i * 2 + 2];
+		float u0 = entries[min_i * 2 + 1];
+		float u1 = entries[min_i * 2 + 3];
+
+		// Lerp between the parameters
+		return (u0 + (t - t0) / (t1 - t0) * (u1 - u0));
+	}
+
+
+	int		nb_entries;
+
+	// Time/parameter pairs
+	float*	entries;
+};
+
+
+#endif	/* _INCLUDED_TIMINGCURVE_H */